@@ -1,270 +1,693 @@
-#include <iostream>
-#include <vector>
-#include <thread>
-#include <pthread.h>
 #include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
 #include <random>
-#include <iomanip>
-#include <cmath>
-
-class MatrixMultiplier {
-private:
-    int N;
-
-    // Структура для передачи данных в поток
-    struct ThreadData {
-        const std::vector<std::vector<int>>* A;
-        const std::vector<std::vector<int>>* B;
-        std::vector<std::vector<int>>* C;
-        int startRow;
-        int endRow;
-        int startCol;
-        int endCol;
-    };
-
-    // Статическая функция для потока
-    static void* multiplyBlock(void* arg) {
-        ThreadData* data = static_cast<ThreadData*>(arg);
-        
-        for (int i = data->startRow; i < data->endRow; i++) {
-            for (int j = data->startCol; j < data->endCol; j++) {
-                int sum = 0;
-                for (int k = 0; k < (int)data->A->size(); k++) {
-                    sum += (*data->A)[i][k] * (*data->B)[k][j];
-                }
-                (*data->C)[i][j] = sum;
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "matrix_multiplier.h"
+
+// Все доступные микроядра на значениях во весь диапазон T: произведения и суммы
+// переполняются, и каждое ядро должно совпасть побитно с переносом по модулю 2^n
+template<class T, class Acc = typename DefaultAccumulator<T>::type>
+void checkKernelsOnOverflow(int size) {
+    typedef typename std::make_unsigned<Acc>::type Wrap;
+    BasicMatrixMultiplier<T, Acc> multiplier(size);
+    Matrix<T> A(size, size);
+    Matrix<T> B(size, size);
+    std::mt19937_64 rng(size);
+    std::uniform_int_distribution<long long> value(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            A(i, j) = static_cast<T>(value(rng));
+            B(i, j) = static_cast<T>(value(rng));
+        }
+    }
+    // Эталон в беззнаковой арифметике: перенос определён стандартом
+    Matrix<Acc> expected(size, size);
+    for (int i = 0; i < size; i++) {
+        for (int j = 0; j < size; j++) {
+            Wrap sum = 0;
+            for (int k = 0; k < size; k++) {
+                sum += static_cast<Wrap>(static_cast<Acc>(A(i, k))) * static_cast<Wrap>(static_cast<Acc>(B(k, j)));
             }
+            expected(i, j) = static_cast<Acc>(sum);
         }
-        
-        delete data; // Освобождаем память
-        return nullptr;
     }
+    std::cout << elementTypeName<T>() << "->" << elementTypeName<Acc>() << ":";
+    for (const MicroKernel<typename KernelSet<T, Acc>::Packed, Acc>* kernel : availableKernels<T, Acc>()) {
+        multiplier.setKernel(*kernel);
+        Matrix<Acc> C = multiplier.multiplyBlocked(A, B);
+        std::cout << " " << kernel->name << " " << (multiplier.areMatricesEqual(expected, C) ? "Да" : "НЕТ!");
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    std::cout << "МНОГОПОТОЧНОЕ УМНОЖЕНИЕ МАТРИЦ (Linux)" << std::endl;
+    std::cout << "========================================" << std::endl;
 
-public:
-    MatrixMultiplier(int size) : N(size) {}
+    // Тестируем для разных размеров матриц
+    std::vector<int> matrixSizes = {100, 200, 500};
 
-    // Обычное умножение матриц (последовательное)
-    std::vector<std::vector<int>> multiplySequential(
-        const std::vector<std::vector<int>>& A,
-        const std::vector<std::vector<int>>& B) {
+    for (int size : matrixSizes) {
+        MatrixMultiplier multiplier(size);
+        // На крупных матрицах пересчёт эталона дороже самих умножений: проверка Фрейвалдса
+        if (size >= 500) {
+            multiplier.setVerification(VerifyMode::Freivalds);
+        }
 
-        std::vector<std::vector<int>> C(N, std::vector<int>(N, 0));
+        std::cout << "\nТЕСТ ДЛЯ МАТРИЦЫ " << size << "x" << size << std::endl;
+        std::cout << "========================================" << std::endl;
 
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                for (int k = 0; k < N; k++) {
-                    C[i][j] += A[i][k] * B[k][j];
-                }
-            }
+        // Тестируем разные размеры блоков
+        std::vector<int> blockSizes;
+        for (int blockSize = 1; blockSize <= size; blockSize *= 2) {
+            if (blockSize > size) break;
+            blockSizes.push_back(blockSize);
         }
+        // Добавляем последний размер блока
+        if (blockSizes.empty() || blockSizes.back() != size) {
+            blockSizes.push_back(size);
+        }
+
+        for (int blockSize : blockSizes) {
+            multiplier.testBlockSize(blockSize);
+        }
+    }
+
+    // Прямоугольные произведения: высокое-узкое, короткое-широкое и с длинным K
+    struct Shape { int m, k, n; };
+    std::vector<Shape> shapes = { {2000, 64, 32}, {32, 64, 2000}, {16, 20000, 16} };
+
+    for (const Shape& shape : shapes) {
+        MatrixMultiplier multiplier(shape.m, shape.k, shape.n);
+
+        std::cout << "\nТЕСТ ДЛЯ МАТРИЦ " << shape.m << "x" << shape.k
+                  << " * " << shape.k << "x" << shape.n << std::endl;
+        std::cout << "========================================" << std::endl;
+
+        multiplier.testBlockSize(0);
+    }
+
+    // Штрассен на нечётной прямоугольной форме с малым порогом: несколько уровней
+    // рекурсии с отщеплением краёв, сверка с последовательным умножением
+    {
+        const int m = 301, k = 237, n = 173, cutoff = 32;
+        MatrixMultiplier multiplier(m, k, n);
+        Matrix<int> A(m, k);
+        Matrix<int> B(k, n);
+        multiplier.fillMatrixRandom(A, 71);
+        multiplier.fillMatrixRandom(B, 72);
+        bool correct = multiplier.areMatricesEqual(multiplier.multiplySequential(A, B),
+            multiplier.multiplyStrassen(A, B, cutoff));
+
+        std::cout << "\nШТРАССЕН " << m << "x" << k << " * " << k << "x" << n << " (порог " << cutoff << ")"
+                  << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::cout << "Совпадает с последовательным: " << (correct ? "Да" : "НЕТ!") << std::endl;
+    }
 
-        return C;
+    // Разные типы элементов и аккумуляторов, у каждого своё микроядро
+    const int typedSize = 300;
+    std::cout << "\nТЕСТ ТИПОВ ЭЛЕМЕНТОВ " << typedSize << "x" << typedSize << std::endl;
+    std::cout << "========================================" << std::endl;
+    BasicMatrixMultiplier<int8_t>(typedSize).testBlockSize(0);
+    BasicMatrixMultiplier<int16_t>(typedSize).testBlockSize(0);
+    BasicMatrixMultiplier<int32_t, int64_t>(typedSize).testBlockSize(0);
+    BasicMatrixMultiplier<int64_t>(typedSize).testBlockSize(0);
+    BasicMatrixMultiplier<float>(typedSize).testBlockSize(0);
+    BasicMatrixMultiplier<double>(typedSize).testBlockSize(0);
+
+    const int overflowSize = 67;
+    std::cout << "\nПЕРЕПОЛНЕНИЕ В МИКРОЯДРАХ " << overflowSize << "x" << overflowSize
+              << " (значения во весь диапазон типа)" << std::endl;
+    std::cout << "========================================" << std::endl;
+    checkKernelsOnOverflow<int16_t>(overflowSize);
+    checkKernelsOnOverflow<int32_t>(overflowSize);
+    checkKernelsOnOverflow<int32_t, int64_t>(overflowSize);
+    checkKernelsOnOverflow<int64_t>(overflowSize);
+
+    // Умножение вне памяти: операнды и результат лежат в файлах и обходятся плитками
+    {
+        const int m = 700, k = 500, n = 600;
+        MatrixMultiplier multiplier(m, k, n);
+        Matrix<int> A(m, k);
+        Matrix<int> B(k, n);
+        multiplier.fillMatrixRandom(A);
+        multiplier.fillMatrixRandom(B);
+        saveMatrix("ooc_a.mat", A, 128, 128);
+        saveMatrix("ooc_b.mat", B, 128, 128);
+
+        std::cout << "\nУМНОЖЕНИЕ ФАЙЛОВ " << m << "x" << k << " * " << k << "x" << n
+                  << " (плитки 128x128, рабочее множество 1 МБ)" << std::endl;
+        std::cout << "========================================" << std::endl;
+        auto start = std::chrono::high_resolution_clock::now();
+        multiplier.multiplyOutOfCore("ooc_a.mat", "ooc_b.mat", "ooc_c.mat", 1 << 20);
+        auto end = std::chrono::high_resolution_clock::now();
+        bool correct = multiplier.areMatricesEqual(multiplier.multiplyBlocked(A, B), loadMatrix<int>("ooc_c.mat"));
+        std::cout << "Время: " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
+                  << " мкс, корректность: " << (correct ? "Да" : "НЕТ!") << std::endl;
+        std::remove("ooc_a.mat");
+        std::remove("ooc_b.mat");
+        std::remove("ooc_c.mat");
     }
 
-    // Многопоточное умножение с блочным разбиением (pthread)
-    std::vector<std::vector<int>> multiplyParallelPthread(
-        const std::vector<std::vector<int>>& A,
-        const std::vector<std::vector<int>>& B,
-        int blockSize) {
-
-        std::vector<std::vector<int>> C(N, std::vector<int>(N, 0));
-        
-        // Вычисляем количество блоков по строкам и столбцам
-        int numBlocksRows = (N + blockSize - 1) / blockSize;
-        int numBlocksCols = (N + blockSize - 1) / blockSize;
-        int totalThreads = numBlocksRows * numBlocksCols;
-        
-        std::vector<pthread_t> threads(totalThreads);
-        int threadIndex = 0;
-
-        // Создаем потоки для каждого блока
-        for (int blockRow = 0; blockRow < numBlocksRows; blockRow++) {
-            for (int blockCol = 0; blockCol < numBlocksCols; blockCol++) {
-                int startRow = blockRow * blockSize;
-                int endRow = std::min(startRow + blockSize, N);
-                int startCol = blockCol * blockSize;
-                int endCol = std::min(startCol + blockSize, N);
-
-                // Создаем данные для потока
-                ThreadData* data = new ThreadData{ &A, &B, &C, startRow, endRow, startCol, endCol };
-
-                // Создаем поток
-                if (pthread_create(&threads[threadIndex], nullptr, multiplyBlock, data) != 0) {
-                    std::cerr << "Ошибка создания потока!" << std::endl;
-                    delete data;
+    // Разреженные операнды: 99% нулей в A, путь выбирается по плотности
+    {
+        const int size = 1000;
+        MatrixMultiplier multiplier(size);
+        Matrix<int> A(size, size);
+        Matrix<int> B(size, size);
+        std::mt19937 gen(7);
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                if (gen() % 100 == 0) {
+                    A(i, j) = static_cast<int>(gen() % 9) + 1;
                 }
-                threadIndex++;
             }
         }
+        multiplier.fillMatrixRandom(B);
+
+        std::cout << "\nРАЗРЕЖЕННАЯ МАТРИЦА " << size << "x" << size << " (1% ненулевых)" << std::endl;
+        std::cout << "========================================" << std::endl;
+        auto start = std::chrono::high_resolution_clock::now();
+        auto C_dense = multiplier.multiplyBlocked(A, B);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto dense_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        start = std::chrono::high_resolution_clock::now();
+        auto C_auto = multiplier.multiplyAuto(A, B);
+        end = std::chrono::high_resolution_clock::now();
+        auto auto_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        std::cout << "Плотное блочное: " << dense_time.count() << " мкс" << std::endl;
+        std::cout << "Автовыбор (" << multiplier.lastAutoPath() << "): " << auto_time.count() << " мкс" << std::endl;
+        std::cout << "Корректность: " << (multiplier.areMatricesEqual(C_dense, C_auto) ? "Да" : "НЕТ!") << std::endl;
+    }
 
-        // Ждем завершения всех потоков
-        for (int i = 0; i < totalThreads; i++) {
-            pthread_join(threads[i], nullptr);
+    // Генерация: последовательный mt19937 против генератора со счётчиком на пуле.
+    // С одним seed матрица побитово совпадает при любом числе потоков.
+    {
+        const int size = 2000;
+        Matrix<int> serial(size, size);
+        auto start = std::chrono::high_resolution_clock::now();
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> dis(0, 9);
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                serial(i, j) = dis(gen);
+            }
         }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto serial_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
-        return C;
+        Matrix<int> single(size, size);
+        Matrix<int> four(size, size);
+        MatrixMultiplier(size, size, size, 1).fillMatrixRandom(single, 42);
+        MatrixMultiplier(size, size, size, 4).fillMatrixRandom(four, 42);
+        MatrixMultiplier multiplier(size);
+        Matrix<int> parallel(size, size);
+        start = std::chrono::high_resolution_clock::now();
+        multiplier.fillMatrixRandom(parallel, 42);
+        end = std::chrono::high_resolution_clock::now();
+        auto parallel_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        std::cout << "\nГЕНЕРАЦИЯ МАТРИЦЫ " << size << "x" << size << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::cout << "mt19937 (последовательно): " << serial_time.count() << " мкс" << std::endl;
+        std::cout << "Со счётчиком (потоков пула: " << multiplier.threadCount() << "): "
+                  << parallel_time.count() << " мкс" << std::endl;
+        bool same = multiplier.areMatricesEqual(single, parallel) && multiplier.areMatricesEqual(four, parallel);
+        std::cout << "Совпадает с 1 и 4 потоками: " << (same ? "Да" : "НЕТ!") << std::endl;
     }
 
-    // Многопоточное умножение с использованием std::thread
-    std::vector<std::vector<int>> multiplyParallelStdThread(
-        const std::vector<std::vector<int>>& A,
-        const std::vector<std::vector<int>>& B,
-        int blockSize) {
-
-        std::vector<std::vector<int>> C(N, std::vector<int>(N, 0));
-        std::vector<std::thread> threads;
-
-        // Вычисляем количество блоков по строкам и столбцам
-        int numBlocksRows = (N + blockSize - 1) / blockSize;
-        int numBlocksCols = (N + blockSize - 1) / blockSize;
-
-        // Создаем потоки для каждого блока
-        for (int blockRow = 0; blockRow < numBlocksRows; blockRow++) {
-            for (int blockCol = 0; blockCol < numBlocksCols; blockCol++) {
-                threads.emplace_back([&, blockRow, blockCol]() {
-                    int startRow = blockRow * blockSize;
-                    int endRow = std::min(startRow + blockSize, N);
-                    int startCol = blockCol * blockSize;
-                    int endCol = std::min(startCol + blockSize, N);
-                    
-                    for (int i = startRow; i < endRow; i++) {
-                        for (int j = startCol; j < endCol; j++) {
-                            int sum = 0;
-                            for (int k = 0; k < N; k++) {
-                                sum += A[i][k] * B[k][j];
-                            }
-                            C[i][j] = sum;
-                        }
-                    }
-                });
+    // Пакет маленьких матриц: цикл отдельных умножений против одного вызова multiplyBatch
+    std::vector<std::pair<int, int>> batches = {{8, 4096}, {32, 1024}};
+    for (const auto& shape : batches) {
+        const int size = shape.first;
+        const int count = shape.second;
+        MatrixMultiplier multiplier(size);
+        MatrixBatch<int> A(count, size, size);
+        MatrixBatch<int> B(count, size, size);
+        std::mt19937 gen(11);
+        for (int b = 0; b < count; b++) {
+            for (int i = 0; i < size * size; i++) {
+                A.data(b)[i] = static_cast<int>(gen() % 10);
+                B.data(b)[i] = static_cast<int>(gen() % 10);
             }
         }
 
-        // Ждем завершения всех потоков
-        for (auto& thread : threads) {
-            thread.join();
+        std::cout << "\nПАКЕТ " << count << " МАТРИЦ " << size << "x" << size << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::vector<Matrix<int>> single(count);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < count; b++) {
+            single[b] = multiplier.multiplyBlocked(A.toMatrix(b), B.toMatrix(b));
         }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto single_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        start = std::chrono::high_resolution_clock::now();
+        MatrixBatch<int> C = multiplier.multiplyBatch(A, B);
+        end = std::chrono::high_resolution_clock::now();
+        auto batch_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
-        return C;
+        bool correct = true;
+        for (int b = 0; b < count && correct; b++) {
+            correct = multiplier.areMatricesEqual(single[b], C.toMatrix(b));
+        }
+        std::cout << "По одной (блочное): " << single_time.count() << " мкс" << std::endl;
+        std::cout << "Пакетом: " << batch_time.count() << " мкс" << std::endl;
+        std::cout << "Корректность: " << (correct ? "Да" : "НЕТ!") << std::endl;
     }
 
-    // Проверка равенства матриц
-    bool areMatricesEqual(const std::vector<std::vector<int>>& A,
-        const std::vector<std::vector<int>>& B) {
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                if (A[i][j] != B[i][j]) {
-                    return false;
+    // Асинхронные произведения A * B[b]: вызывающий поток готовит следующие операнды,
+    // пока предыдущие произведения считаются на пуле; продолжения считают суммы элементов
+    {
+        const int size = 300;
+        const int count = 4;
+        MatrixMultiplier multiplier(size);
+        auto A = std::make_shared<Matrix<int>>(size, size);
+        multiplier.fillMatrixRandom(*A, 1);
+        std::vector<std::shared_ptr<Matrix<int>>> B;
+        std::vector<MatrixFuture<Matrix<int>>> products;
+        std::vector<MatrixFuture<long long>> sums;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < count; b++) {
+            B.push_back(std::make_shared<Matrix<int>>(size, size));
+            multiplier.fillMatrixRandom(*B.back(), 2 + b);
+            products.push_back(multiplier.multiplyAsync(A, B.back()));
+            sums.push_back(products.back().then([](const Matrix<int>& C) {
+                long long sum = 0;
+                for (int i = 0; i < C.rows(); i++) {
+                    for (int j = 0; j < C.cols(); j++) {
+                        sum += C(i, j);
+                    }
                 }
-            }
+                return sum;
+            }));
         }
-        return true;
-    }
+        std::vector<MatrixFuture<Matrix<int>>> pending = products;
+        std::vector<int> index;
+        for (int b = 0; b < count; b++) {
+            index.push_back(b);
+        }
+        std::string order;
+        while (!pending.empty()) {
+            size_t first = waitAny(pending);
+            order += " " + std::to_string(index[first]);
+            pending.erase(pending.begin() + first);
+            index.erase(index.begin() + first);
+        }
+        waitAll(sums);
+        auto end = std::chrono::high_resolution_clock::now();
 
-    // Заполнение матрицы случайными значениями
-    void fillMatrixRandom(std::vector<std::vector<int>>& matrix) {
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, 9);
-        
-        for (int i = 0; i < N; i++) {
-            for (int j = 0; j < N; j++) {
-                matrix[i][j] = dis(gen);
+        bool correct = true;
+        for (int b = 0; b < count; b++) {
+            Matrix<int> expected = multiplier.multiplyBlocked(*A, *B[b]);
+            long long sum = 0;
+            for (int i = 0; i < size; i++) {
+                for (int j = 0; j < size; j++) {
+                    sum += expected(i, j);
+                }
             }
+            correct = correct && multiplier.areMatricesEqual(expected, products[b].get()) && sums[b].get() == sum;
         }
+
+        std::cout << "\nАСИНХРОННЫЕ ПРОИЗВЕДЕНИЯ " << count << " x " << size << "x" << size << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::cout << "Время (с генерацией операндов): "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << " мкс" << std::endl;
+        std::cout << "Порядок готовности:" << order << std::endl;
+        std::cout << "Корректность (с продолжениями): " << (correct ? "Да" : "НЕТ!") << std::endl;
     }
 
-    // Тестирование для одного размера блока
-    void testBlockSize(int blockSize) {
-        // Создаем матрицы
-        std::vector<std::vector<int>> A(N, std::vector<int>(N));
-        std::vector<std::vector<int>> B(N, std::vector<int>(N));
+    // Цепочка прямоугольных множителей: попарно слева направо против порядка,
+    // выбранного динамическим программированием
+    {
+        const std::vector<int> dims = {900, 12, 800, 10, 1000, 16, 700};
+        std::vector<Matrix<int>> factors;
+        for (size_t f = 0; f + 1 < dims.size(); f++) {
+            factors.emplace_back(dims[f], dims[f + 1]);
+            MatrixMultiplier(dims[f], dims[f], dims[f + 1]).fillMatrixRandom(factors.back(), 100 + f);
+        }
 
-        // Заполняем случайными значениями
-        fillMatrixRandom(A);
-        fillMatrixRandom(B);
+        auto start = std::chrono::high_resolution_clock::now();
+        Matrix<int> pairwise = factors[0];
+        for (size_t f = 1; f < factors.size(); f++) {
+            pairwise = MatrixMultiplier(dims[0], dims[f], dims[f + 1]).multiplyBlocked(pairwise, factors[f]);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto pairwise_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
-        // Вычисляем количество блоков и потоков
-        int numBlocksRows = (N + blockSize - 1) / blockSize;
-        int numBlocksCols = (N + blockSize - 1) / blockSize;
-        int totalBlocks = numBlocksRows * numBlocksCols;
+        MatrixMultiplier multiplier(1);
+        start = std::chrono::high_resolution_clock::now();
+        Matrix<int> chain = multiplier.multiplyChain(factors);
+        end = std::chrono::high_resolution_clock::now();
+        auto chain_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        const long long allocations = multiplier.chainAllocations();
+        multiplier.multiplyChain(factors);
+
+        const ChainPlan& plan = multiplier.chainPlan();
+        std::cout << "\nЦЕПОЧКА ИЗ " << plan.factors() << " МНОЖИТЕЛЕЙ" << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::cout << "Слева направо: " << pairwise_time.count() << " мкс, "
+                  << static_cast<long long>(plan.leftToRightFlops) << " операций" << std::endl;
+        std::cout << "Порядок " << plan.order() << ": " << chain_time.count() << " мкс, "
+                  << static_cast<long long>(plan.flops) << " операций" << std::endl;
+        std::cout << "Буферов выделено: " << allocations << ", при повторном вызове: "
+                  << multiplier.chainAllocations() - allocations << std::endl;
+        std::cout << "Корректность: " << (multiplier.areMatricesEqual(pairwise, chain) ? "Да" : "НЕТ!") << std::endl;
+    }
 
-        std::cout << "Матрица: " << N << "x" << N;
-        std::cout << ", Блок: " << blockSize;
-        std::cout << ", Блоков: " << totalBlocks;
-        std::cout << ", Потоков: " << totalBlocks << std::endl;
+    // Умножение в готовую матрицу: после первого вызова буферы умножителя уже
+    // подходят, и повторные вызовы не выделяют память
+    {
+        const int size = 300;
+        const int rounds = 20;
+        MatrixMultiplier multiplier(size);
+        Matrix<int> A(size, size);
+        Matrix<int> B(size, size);
+        multiplier.fillMatrixRandom(A, 21);
+        multiplier.fillMatrixRandom(B, 22);
 
-        // Тестируем последовательное умножение
+        long long allocations = alignedAllocations.load();
         auto start = std::chrono::high_resolution_clock::now();
-        auto C_seq = multiplySequential(A, B);
+        Matrix<int> fresh;
+        for (int r = 0; r < rounds; r++) {
+            fresh = multiplier.multiplyBlocked(A, B);
+        }
         auto end = std::chrono::high_resolution_clock::now();
-        auto seq_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        auto fresh_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        const long long freshAllocations = alignedAllocations.load() - allocations;
 
-        // Тестируем параллельное умножение (std::thread)
+        Matrix<int> C(size, size);
+        allocations = alignedAllocations.load();
         start = std::chrono::high_resolution_clock::now();
-        auto C_par_std = multiplyParallelStdThread(A, B, blockSize);
+        for (int r = 0; r < rounds; r++) {
+            multiplier.multiplyBlocked(A, B, C);
+        }
         end = std::chrono::high_resolution_clock::now();
-        auto par_std_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        auto into_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        const long long intoAllocations = alignedAllocations.load() - allocations;
+
+        // C += A * B поверх уже посчитанного A * B даёт 2 * A * B
+        multiplier.multiplyParallelPool(A, B, C, 0, GemmOutput::Accumulate);
+        bool accumulated = true;
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                accumulated = accumulated && C(i, j) == 2 * fresh(i, j);
+            }
+        }
 
-        // Тестируем параллельное умножение (pthread)
-        start = std::chrono::high_resolution_clock::now();
-        auto C_par_pthread = multiplyParallelPthread(A, B, blockSize);
-        end = std::chrono::high_resolution_clock::now();
-        auto par_pthread_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        std::cout << "\nУМНОЖЕНИЕ В ГОТОВУЮ МАТРИЦУ " << size << "x" << size << ", " << rounds << " раз" << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::cout << "Новая матрица на вызов: " << fresh_time.count() << " мкс, выделений: "
+                  << freshAllocations << std::endl;
+        std::cout << "В готовую матрицу: " << into_time.count() << " мкс, выделений: "
+                  << intoAllocations << std::endl;
+        std::cout << "Корректность (с накоплением): " << (accumulated ? "Да" : "НЕТ!") << std::endl;
+    }
 
-        // Проверяем корректность
-        bool correct_std = areMatricesEqual(C_seq, C_par_std);
-        bool correct_pthread = areMatricesEqual(C_seq, C_par_pthread);
+    // Страницы под матрицы: обычные, прозрачные большие (MADV_HUGEPAGE) и MAP_HUGETLB.
+    // Операнды заполняются на пуле, страницы C затрагиваются заранее, поэтому
+    // в замер попадает только само умножение
+    {
+        const int size = 1024;
+        MatrixMultiplier multiplier(size);
+        std::cout << "\nБОЛЬШИЕ СТРАНИЦЫ " << size << "x" << size << " (большая страница "
+                  << hugePageSize() / 1024 << " КиБ)" << std::endl;
+        std::cout << "========================================" << std::endl;
+        Matrix<int> first;
+        for (MatrixPages pages : { MatrixPages::Small, MatrixPages::Transparent, MatrixPages::Huge }) {
+            Matrix<int> A = Matrix<int>::uninitialized(size, size, pages);
+            Matrix<int> B = Matrix<int>::uninitialized(size, size, pages);
+            Matrix<int> C = Matrix<int>::uninitialized(size, size, pages);
+            multiplier.fillMatrixRandom(A, 31);
+            multiplier.fillMatrixRandom(B, 32);
+            C.prefault(ThreadPool::shared());
+
+            auto start = std::chrono::high_resolution_clock::now();
+            multiplier.multiplyBlocked(A, B, C);
+            auto end = std::chrono::high_resolution_clock::now();
+            if (first.empty()) {
+                first = C;
+            }
 
-        double speedup_std = 0.0;
-        double speedup_pthread = 0.0;
-        
-        if (par_std_time.count() > 0) {
-            speedup_std = static_cast<double>(seq_time.count()) / par_std_time.count();
+            std::cout << "Запрошены " << matrixPagesName(pages) << ", получены " << matrixPagesName(B.pages());
+            const long long hugeBytes = hugePageBytes(B.data());
+            if (hugeBytes >= 0) {
+                std::cout << " (B в больших страницах: " << hugeBytes / (1024 * 1024) << " МиБ)";
+            }
+            std::cout << ", время: " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
+                      << " мкс, корректность: " << (multiplier.areMatricesEqual(first, C) ? "Да" : "НЕТ!") << std::endl;
         }
-        if (par_pthread_time.count() > 0) {
-            speedup_pthread = static_cast<double>(seq_time.count()) / par_pthread_time.count();
+    }
+
+    // Ложное разделение C: мелкие плитки пишут в общие кэш-линии, выровненные по линиям
+    // плитки считаются в буфер потока и переносятся в C потоковыми записями
+    {
+        const int size = 256;
+        const int block = 4;
+        MatrixMultiplier multiplier(size);
+        Matrix<int> A(size, size);
+        Matrix<int> B(size, size);
+        multiplier.fillMatrixRandom(A, 41);
+        multiplier.fillMatrixRandom(B, 42);
+        Matrix<int> expected = multiplier.multiplyBlocked(A, B);
+
+        std::cout << "\nЛОЖНОЕ РАЗДЕЛЕНИЕ C " << size << "x" << size << ", блок " << block << std::endl;
+        std::cout << "========================================" << std::endl;
+        for (bool aligned : { false, true }) {
+            multiplier.setLineAlignedTiles(aligned);
+            const Partition partition = multiplier.partition(block);
+            const int line = MatrixMultiplier::lineElements();
+            const double shared = 100.0 * partition.sharedLines(line) / std::max(1LL, partition.outputLines(line));
+
+            auto start = std::chrono::high_resolution_clock::now();
+            Matrix<int> C = multiplier.multiplyParallelPool(A, B, block);
+            auto end = std::chrono::high_resolution_clock::now();
+
+            std::cout << (aligned ? "По кэш-линиям: " : "Общие линии: ") << partition.tiles() << " плиток, "
+                      << "общих линий " << std::fixed << std::setprecision(1) << shared << "%"
+                      << std::defaultfloat << ", время: "
+                      << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
+                      << " мкс, корректность: " << (multiplier.areMatricesEqual(expected, C) ? "Да" : "НЕТ!") << std::endl;
         }
+        multiplier.setLineAlignedTiles(false);
+    }
 
-        std::cout << "Последовательное: " << seq_time.count() << " мкс" << std::endl;
-        std::cout << "Параллельное (std::thread): " << par_std_time.count() << " мкс";
-        std::cout << " (ускорение: " << std::fixed << std::setprecision(2) << speedup_std << "x)" << std::endl;
-        std::cout << "Параллельное (pthread): " << par_pthread_time.count() << " мкс";
-        std::cout << " (ускорение: " << std::fixed << std::setprecision(2) << speedup_pthread << "x)" << std::endl;
-        std::cout << "Корректность std::thread: " << (correct_std ? "Да" : "НЕТ!") << std::endl;
-        std::cout << "Корректность pthread: " << (correct_pthread ? "Да" : "НЕТ!") << std::endl;
-        std::cout << "----------------------------------------" << std::endl;
+    // Распределённое умножение: рабочие процессы на решётке 2x2 обмениваются панелями
+    // A и B через общую память или сокеты Unix; у каждого своё время счёта и ожидания
+    {
+        const int size = 500;
+        MatrixMultiplier multiplier(size);
+        Matrix<int> A(size, size);
+        Matrix<int> B(size, size);
+        multiplier.fillMatrixRandom(A, 51);
+        multiplier.fillMatrixRandom(B, 52);
+        Matrix<int> expected = multiplier.multiplyBlocked(A, B);
+
+        DistributedOptions options;
+        std::cout << "\nРАСПРЕДЕЛЁННОЕ УМНОЖЕНИЕ " << size << "x" << size << " (SUMMA, " << options.workers
+                  << " процесса, блок " << options.block << ")" << std::endl;
+        std::cout << "========================================" << std::endl;
+        for (DistributedTransport transport : { DistributedTransport::SharedMemory, DistributedTransport::UnixSocket }) {
+            options.transport = transport;
+            Matrix<int> C = multiplier.multiplyDistributed(A, B, options);
+            const DistributedReport& report = multiplier.distributedReport();
+            std::cout << "Транспорт " << distributedTransportName(transport) << ", решётка " << report.gridRows
+                      << "x" << report.gridCols << ", шагов " << report.steps << ", время: "
+                      << static_cast<long long>(report.totalUs) << " мкс, скрыто связи: "
+                      << static_cast<int>(report.overlap() * 100.0) << "%, корректность: "
+                      << (multiplier.areMatricesEqual(expected, C) ? "Да" : "НЕТ!") << std::endl;
+            for (const DistributedWorkerStats& worker : report.workers) {
+                std::cout << "  рабочий " << worker.worker << " (" << worker.gridRow << "," << worker.gridCol
+                          << "): приём блоков " << static_cast<long long>(worker.scatterUs)
+                          << " мкс, счёт " << static_cast<long long>(worker.computeUs)
+                          << " мкс, ожидание панелей " << static_cast<long long>(worker.waitUs)
+                          << " мкс, всего " << static_cast<long long>(worker.totalUs)
+                          << " мкс, отправлено " << worker.bytesSent / 1024 << " КиБ" << std::endl;
+            }
+        }
     }
-};
 
-int main() {
-    std::cout << "МНОГОПОТОЧНОЕ УМНОЖЕНИЕ МАТРИЦ (Linux)" << std::endl;
-    std::cout << "========================================" << std::endl;
+    // Квантованное умножение: операнды в 8 битах (вчетверо меньше int32), суммы в int32.
+    // Целые из диапазона квантуются без потерь, вещественные — с ошибкой шага квантования
+    {
+        const int size = 500;
+        MatrixMultiplier multiplier(size);
+        Matrix<int> A(size, size);
+        Matrix<int> B(size, size);
+        multiplier.fillMatrixRandom(A, 61);
+        multiplier.fillMatrixRandom(B, 62);
+        Matrix<int> expected = multiplier.multiplySequential(A, B);
 
-    // Тестируем для разных размеров матриц
-    std::vector<int> matrixSizes = {100, 200, 500};
+        auto start = std::chrono::high_resolution_clock::now();
+        Matrix<int> blocked = multiplier.multiplyBlocked(A, B);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto blocked_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
-    for (int size : matrixSizes) {
-        MatrixMultiplier multiplier(size);
+        start = std::chrono::high_resolution_clock::now();
+        Matrix<int> quantized = multiplier.multiplyQuantized(A, B);
+        end = std::chrono::high_resolution_clock::now();
+        auto quantized_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
-        std::cout << "\nТЕСТ ДЛЯ МАТРИЦЫ " << size << "x" << size << std::endl;
+        const long long operandBytes = 2LL * size * size;
+        std::cout << "\nКВАНТОВАННОЕ УМНОЖЕНИЕ " << size << "x" << size << " (u8 x s8 -> int32)" << std::endl;
         std::cout << "========================================" << std::endl;
+        std::cout << "Операнды: " << operandBytes * sizeof(int) / 1024 << " КиБ в int, "
+                  << operandBytes / 1024 << " КиБ в 8 битах" << std::endl;
+        std::cout << "Блочное (" << multiplier.currentKernel().name << "): " << blocked_time.count() << " мкс, "
+                  << "квантованное (" << multiplier.quantizedKernelName() << "): " << quantized_time.count()
+                  << " мкс" << std::endl;
+        std::cout << "Совпадает с последовательным: "
+                  << (multiplier.areMatricesEqual(expected, quantized) && multiplier.areMatricesEqual(expected, blocked)
+                      ? "Да" : "НЕТ!") << std::endl;
+
+        // int64: окно из 256 значений далеко от нуля (около -2^40), zeroPoint не влезает в int32
+        BasicMatrixMultiplier<int64_t> wide(size);
+        Matrix<int64_t> WA(size, size);
+        Matrix<int64_t> WB(size, size);
+        fillUniform(WA.view(), 64, -(int64_t(1) << 40) - 255, -(int64_t(1) << 40), ThreadPool::shared());
+        fillUniform(WB.view(), 65, int64_t(-128), int64_t(127), ThreadPool::shared());
+        std::cout << "int64 около -2^40 совпадает с последовательным: "
+                  << (wide.areMatricesEqual(wide.multiplySequential(WA, WB), wide.multiplyQuantized(WA, WB))
+                      ? "Да" : "НЕТ!") << std::endl;
+
+        BasicMatrixMultiplier<double> real(size);
+        Matrix<double> X(size, size);
+        Matrix<double> Y(size, size);
+        std::mt19937 rng(63);
+        std::uniform_real_distribution<double> value(-1.0, 1.0);
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                X(i, j) = value(rng);
+                Y(i, j) = value(rng);
+            }
+        }
+        Matrix<double> exact = real.multiplyBlocked(X, Y);
+        Matrix<double> approx = real.multiplyQuantized(X, Y);
+        double error = 0.0;
+        double norm = 0.0;
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                error += (exact(i, j) - approx(i, j)) * (exact(i, j) - approx(i, j));
+                norm += exact(i, j) * exact(i, j);
+            }
+        }
+        const double relative = std::sqrt(error / norm);
+        std::cout << "double в [-1, 1]: относительная ошибка " << std::fixed << std::setprecision(2)
+                  << relative * 100.0 << "%" << std::defaultfloat << ", в пределах 2%: "
+                  << (relative < 0.02 ? "Да" : "НЕТ!") << std::endl;
+    }
 
-        // Тестируем разные размеры блоков
-        std::vector<int> blockSizes;
-        for (int blockSize = 1; blockSize <= size; blockSize *= 2) {
-            if (blockSize > size) break;
-            blockSizes.push_back(blockSize);
+    // Степень матрицы: k - 1 умножений подряд против двоичного возведения,
+    // и то же по модулю против прямого счёта в int64_t
+    {
+        const int size = 200;
+        const uint64_t k = 37;
+        const int64_t modulus = 1000000007;
+        MatrixMultiplier multiplier(size);
+        Matrix<int> A(size, size);
+        multiplier.fillMatrixRandom(A, 37);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        Matrix<int> repeated = A;
+        for (uint64_t p = 1; p < k; p++) {
+            repeated = multiplier.multiplyBlocked(repeated, A);
         }
-        // Добавляем последний размер блока
-        if (blockSizes.empty() || blockSizes.back() != size) {
-            blockSizes.push_back(size);
+        auto end = std::chrono::high_resolution_clock::now();
+        auto repeated_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        start = std::chrono::high_resolution_clock::now();
+        Matrix<int> power = multiplier.power(A, k);
+        end = std::chrono::high_resolution_clock::now();
+        auto power_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        const int products = multiplier.powerProducts();
+
+        Matrix<int> powerMod = multiplier.powerMod(A, k, modulus);
+        Matrix<int64_t> expected(size, size);
+        Matrix<int64_t> next(size, size);
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                expected(i, j) = A(i, j);
+            }
+        }
+        for (uint64_t p = 1; p < k; p++) {
+            for (int i = 0; i < size; i++) {
+                for (int j = 0; j < size; j++) {
+                    int64_t sum = 0;
+                    for (int t = 0; t < size; t++) {
+                        sum = (sum + expected(i, t) * A(t, j)) % modulus;
+                    }
+                    next(i, j) = sum;
+                }
+            }
+            expected.swap(next);
+        }
+        bool modCorrect = true;
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                modCorrect = modCorrect && powerMod(i, j) == expected(i, j);
+            }
         }
 
-        for (int blockSize : blockSizes) {
-            multiplier.testBlockSize(blockSize);
+        std::cout << "\nСТЕПЕНЬ МАТРИЦЫ " << size << "x" << size << " ^ " << k << std::endl;
+        std::cout << "========================================" << std::endl;
+        std::cout << "Умножений подряд: " << k - 1 << ", время: " << repeated_time.count() << " мкс" << std::endl;
+        std::cout << "Возведением в квадрат: " << products << " умножений, время: " << power_time.count()
+                  << " мкс" << std::endl;
+        std::cout << "Корректность: " << (multiplier.areMatricesEqual(repeated, power) ? "Да" : "НЕТ!") << std::endl;
+        std::cout << "По модулю " << modulus << ": " << (modCorrect ? "Да" : "НЕТ!") << std::endl;
+    }
+
+    // Автонастройка: первый запуск перебирает конфигурации и пишет профиль,
+    // второй берёт ту же конфигурацию из профиля без замеров. Профиль временный,
+    // чтобы демонстрация не писала в ~/.cache и каждый раз проходила перебор.
+    const std::string profilePath = "autotune_demo.profile";
+    std::remove(profilePath.c_str());
+    std::cout << "\nАВТОНАСТРОЙКА" << std::endl;
+    std::cout << "========================================" << std::endl;
+    for (int size : matrixSizes) {
+        Matrix<int> A(size, size);
+        Matrix<int> B(size, size);
+        TunedConfig searched;
+        for (int pass = 0; pass < 2; pass++) {
+            MatrixMultiplier multiplier(size);
+            multiplier.setTuningProfile(profilePath);
+            const TunedConfig& config = multiplier.autoTune();
+            if (pass == 0) {
+                searched = config;
+                multiplier.fillMatrixRandom(A);
+                multiplier.fillMatrixRandom(B);
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+            auto C = multiplier.multiply(A, B);
+            auto end = std::chrono::high_resolution_clock::now();
+            bool correct = multiplier.areMatricesEqual(multiplier.multiplyBlocked(A, B), C);
+            // Второй проход обязан прочитать из профиля то, что нашёл перебор
+            bool fromProfile = multiplier.tunedConfigFromProfile();
+            bool expectedSource = pass == 0 ? !fromProfile
+                : fromProfile && config.variant == searched.variant && config.kernel == searched.kernel
+                    && config.block == searched.block && config.threads == searched.threads;
+
+            std::cout << "Матрица " << size << "x" << size << ": " << config.variant;
+            if (config.kernel != "-") {
+                std::cout << " (" << config.kernel << ")";
+            }
+            std::cout << ", блок " << config.block << ", потоков " << config.threads
+                      << (fromProfile ? ", из профиля" : ", перебором")
+                      << ", время: " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
+                      << " мкс, корректность: " << (correct && expectedSource ? "Да" : "НЕТ!") << std::endl;
         }
     }
+    std::remove(profilePath.c_str());
+    std::remove((profilePath + ".lock").c_str());
 
     return 0;
 }
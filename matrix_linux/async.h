@@ -0,0 +1,290 @@
+#ifndef ASYNC_H_
+#define ASYNC_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "thread_pool.h"
+
+// Асинхронные результаты на пуле: задача ставится в очередь пула, вызывающий поток
+// получает MatrixFuture и может ждать его, ждать первого или всех из нескольких
+// или навесить продолжение, которое выполнится на том же пуле.
+// Ждать (wait, get, waitAny, waitAll) внутри задачи того же пула не стоит: занятый
+// ожиданием рабочий не берёт задачи. Из задач пула цепочки строятся через then().
+
+namespace async_detail {
+
+// Состояние без типа результата: готовность, исключение и обратные вызовы
+class StateBase {
+public:
+    StateBase() : done_(false) {}
+
+    bool ready() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return done_;
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCv_.wait(lock, [this]() { return done_; });
+    }
+
+    template<class Rep, class Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return doneCv_.wait_for(lock, timeout, [this]() { return done_; });
+    }
+
+    // callback выполняется один раз после завершения: сразу, если состояние уже готово,
+    // иначе в потоке, который его завершил
+    void onReady(std::function<void()> callback) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!done_) {
+                callbacks_.push_back(std::move(callback));
+                return;
+            }
+        }
+        callback();
+    }
+
+    // Исключение задачи; читается только после готовности
+    std::exception_ptr error() const { return error_; }
+
+    void fail(std::exception_ptr error) {
+        error_ = error;
+        complete();
+    }
+
+protected:
+    // Результат и error_ записаны до done_ под мьютексом, поэтому видны дождавшимся
+    void complete() {
+        std::vector<std::function<void()>> callbacks;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_ = true;
+            callbacks.swap(callbacks_);
+        }
+        doneCv_.notify_all();
+        for (auto& callback : callbacks) {
+            callback();
+        }
+    }
+
+    std::exception_ptr error_;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable doneCv_;
+    bool done_;
+    std::vector<std::function<void()>> callbacks_;
+};
+
+template<class R>
+class State : public StateBase {
+public:
+    template<class F, class... Args>
+    void run(F& fn, Args&&... args) {
+        try {
+            value_.reset(new R(fn(std::forward<Args>(args)...)));
+        } catch (...) {
+            error_ = std::current_exception();
+        }
+        complete();
+    }
+
+    const R& value() const { return *value_; }
+
+private:
+    std::unique_ptr<R> value_;
+};
+
+template<>
+class State<void> : public StateBase {
+public:
+    template<class F, class... Args>
+    void run(F& fn, Args&&... args) {
+        try {
+            fn(std::forward<Args>(args)...);
+        } catch (...) {
+            error_ = std::current_exception();
+        }
+        complete();
+    }
+
+    void value() const {}
+};
+
+template<class R>
+struct GetResult { typedef const R& type; };
+
+template<>
+struct GetResult<void> { typedef void type; };
+
+// Тип результата продолжения fn(const R&) или fn()
+template<class R, class F>
+struct ThenResult { typedef decltype(std::declval<F&>()(std::declval<const R&>())) type; };
+
+template<class F>
+struct ThenResult<void, F> { typedef decltype(std::declval<F&>()()) type; };
+
+} // namespace async_detail
+
+// Дескриптор асинхронной операции без типа результата: для ожидания
+// нескольких операций с разными результатами
+class AsyncHandle {
+public:
+    AsyncHandle() {}
+
+    bool valid() const { return state_ != nullptr; }
+
+    bool ready() const {
+        requireState();
+        return state_->ready();
+    }
+
+    void wait() const {
+        requireState();
+        state_->wait();
+    }
+
+    // false — операция не завершилась за timeout
+    template<class Rep, class Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const {
+        requireState();
+        return state_->waitFor(timeout);
+    }
+
+    // Вызов после завершения (в потоке, завершившем операцию); для лёгких действий
+    void onReady(std::function<void()> callback) const {
+        requireState();
+        state_->onReady(std::move(callback));
+    }
+
+protected:
+    explicit AsyncHandle(std::shared_ptr<async_detail::StateBase> state) : state_(std::move(state)) {}
+
+    void requireState() const {
+        if (!state_) {
+            throw std::logic_error("AsyncHandle: no associated operation");
+        }
+    }
+
+    std::shared_ptr<async_detail::StateBase> state_;
+};
+
+// Результат операции на пуле. Копии разделяют одно состояние, как у std::shared_future.
+template<class R>
+class MatrixFuture : public AsyncHandle {
+public:
+    MatrixFuture() : pool_(nullptr) {}
+
+    // Создаётся submitAsync и then(): состояние и пул для продолжений
+    MatrixFuture(std::shared_ptr<async_detail::State<R>> state, ThreadPool* pool)
+        : AsyncHandle(std::move(state)), pool_(pool) {}
+
+    // Ждёт завершения; исключение задачи пробрасывается вызывающему
+    typename async_detail::GetResult<R>::type get() const {
+        wait();
+        if (state()->error()) {
+            std::rethrow_exception(state()->error());
+        }
+        return state()->value();
+    }
+
+    // Продолжение fn(результат) (или fn() для void) ставится в очередь того же пула,
+    // когда операция завершится. Если операция завершилась исключением, fn не
+    // вызывается, а исключение переходит в результат продолжения.
+    template<class F>
+    MatrixFuture<typename async_detail::ThenResult<R, F>::type> then(F fn) const {
+        typedef typename async_detail::ThenResult<R, F>::type Next;
+        requireState();
+        std::shared_ptr<async_detail::State<R>> source = state();
+        std::shared_ptr<async_detail::State<Next>> next = std::make_shared<async_detail::State<Next>>();
+        ThreadPool* pool = pool_;
+        source->onReady([source, next, pool, fn]() mutable {
+            pool->submit([source, next, fn]() mutable {
+                if (source->error()) {
+                    next->fail(source->error());
+                } else if constexpr (std::is_void<R>::value) {
+                    next->run(fn);
+                } else {
+                    next->run(fn, source->value());
+                }
+            });
+        });
+        return MatrixFuture<Next>(next, pool_);
+    }
+
+private:
+    std::shared_ptr<async_detail::State<R>> state() const {
+        return std::static_pointer_cast<async_detail::State<R>>(state_);
+    }
+
+    ThreadPool* pool_;
+};
+
+// Выполнить fn() на пуле; результат и исключение — в возвращённом MatrixFuture
+template<class F>
+MatrixFuture<typename std::result_of<F&()>::type> submitAsync(ThreadPool& pool, F fn) {
+    typedef typename std::result_of<F&()>::type R;
+    std::shared_ptr<async_detail::State<R>> state = std::make_shared<async_detail::State<R>>();
+    pool.submit([state, fn]() mutable { state->run(fn); });
+    return MatrixFuture<R>(state, &pool);
+}
+
+// Ждать все операции; исключения не пробрасываются (их вернёт get())
+template<class Handle>
+void waitAll(const std::vector<Handle>& handles) {
+    for (const Handle& handle : handles) {
+        handle.wait();
+    }
+}
+
+// Номер первой завершившейся операции; если готовы уже несколько — наименьший номер.
+// Вызывающий поток спит, пока одна из операций не завершится.
+template<class Handle>
+size_t waitAny(const std::vector<Handle>& handles) {
+    if (handles.empty()) {
+        throw std::invalid_argument("waitAny: no operations to wait for");
+    }
+    for (size_t i = 0; i < handles.size(); i++) {
+        if (handles[i].ready()) {
+            return i;
+        }
+    }
+    struct Any {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t first;
+        bool done;
+    };
+    std::shared_ptr<Any> any = std::make_shared<Any>();
+    any->done = false;
+    any->first = 0;
+    for (size_t i = 0; i < handles.size(); i++) {
+        handles[i].onReady([any, i]() {
+            {
+                std::unique_lock<std::mutex> lock(any->mutex);
+                if (any->done) {
+                    return;
+                }
+                any->done = true;
+                any->first = i;
+            }
+            any->cv.notify_all();
+        });
+    }
+    std::unique_lock<std::mutex> lock(any->mutex);
+    any->cv.wait(lock, [&any]() { return any->done; });
+    return any->first;
+}
+
+#endif // ASYNC_H_
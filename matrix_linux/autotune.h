@@ -0,0 +1,270 @@
+#ifndef AUTOTUNE_H_
+#define AUTOTUNE_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "cpu_features.h"
+#include "gemm.h"
+#include "numa.h"
+
+// Лучшая найденная конфигурация умножения для одной формы и типа
+struct TunedConfig {
+    std::string variant; // blocked, strassen, pool, steal
+    std::string kernel;  // микроядро для blocked/strassen, "-" для остальных
+    int block;           // размер блока (зерно для steal, cutoff для strassen), 0 — авто
+    int threads;         // размер пула
+    double medianUs;     // медианное время при настройке
+};
+
+// Отпечаток оборудования: модель процессора, число CPU, кэши, наборы инструкций и узлы NUMA.
+// Смена любого из них делает старые записи профиля неприменимыми.
+struct HardwareFingerprint {
+    std::string description;
+    std::string hash; // FNV-1a от description, 16 шестнадцатеричных цифр
+
+    static const HardwareFingerprint& detect() {
+        static const HardwareFingerprint fingerprint = query();
+        return fingerprint;
+    }
+
+private:
+    static HardwareFingerprint query() {
+        const CpuFeatures& f = CpuFeatures::detect();
+        const CacheInfo& cache = CacheInfo::detect();
+        std::ostringstream text;
+        text << cpuModelName() << "; cpus=" << std::thread::hardware_concurrency()
+             << "; l1=" << cache.l1 << " l2=" << cache.l2 << " l3=" << cache.l3 << ";";
+        const bool flags[] = { f.sse41, f.avx2, f.fma, f.avx512f, f.avx512bw, f.avx512dq, f.avx512vnni, f.avxvnni };
+        const char* names[] = { "sse4.1", "avx2", "fma", "avx512f", "avx512bw", "avx512dq", "avx512vnni", "avxvnni" };
+        for (size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+            if (flags[i]) {
+                text << " " << names[i];
+            }
+        }
+        text << "; nodes=" << NumaTopology::detect().nodes();
+
+        HardwareFingerprint fingerprint;
+        fingerprint.description = text.str();
+        uint64_t h = 1469598103934665603ull;
+        for (unsigned char c : fingerprint.description) {
+            h = (h ^ c) * 1099511628211ull;
+        }
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(h));
+        fingerprint.hash = hex;
+        return fingerprint;
+    }
+};
+
+// Профиль настройки на диске. Формат — текст, одна запись на строку:
+//   <отпечаток> <тип> <M> <K> <N> <вариант> <ядро> <блок> <потоки> <мкс>
+// Строки "# <отпечаток> <описание>" поясняют отпечатки. Записи других машин
+// сохраняются, поэтому один файл можно держать в общем домашнем каталоге.
+// Рядом лежит <профиль>.lock — блокировка записи.
+class TuningProfile {
+public:
+    static const int kMaxTunedBlock = 1 << 16; // больше любого перебираемого блока и порога
+    static const int kMaxThreadsPerCpu = 4;    // потоков в записи на один CPU машины
+
+    explicit TuningProfile(const std::string& path = defaultPath()) : path_(path) {
+        load();
+    }
+
+    const std::string& path() const { return path_; }
+
+    // $MATRIX_TUNING_PROFILE, иначе $XDG_CACHE_HOME или ~/.cache, иначе текущий каталог.
+    // Только вычисляет путь: каталог создаёт save()
+    static std::string defaultPath() {
+        if (const char* path = std::getenv("MATRIX_TUNING_PROFILE")) {
+            return path;
+        }
+        std::string dir;
+        if (const char* cache = std::getenv("XDG_CACHE_HOME")) {
+            dir = cache;
+        } else if (const char* home = std::getenv("HOME")) {
+            dir = std::string(home) + "/.cache";
+        }
+        return dir.empty() ? "matrix_tuning.profile" : dir + "/matrix_tuning.profile";
+    }
+
+    bool find(const std::string& fingerprint, const std::string& type, int m, int k, int n,
+        TunedConfig& config) const {
+        for (const Entry& entry : entries_) {
+            if (entry.fingerprint == fingerprint && entry.type == type
+                && entry.m == m && entry.k == k && entry.n == n) {
+                config = entry.config;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(const HardwareFingerprint& fingerprint, const std::string& type, int m, int k, int n,
+        const TunedConfig& config) {
+        descriptions_.push_back(Description{ fingerprint.hash, fingerprint.description });
+        put(Entry{ fingerprint.hash, type, m, k, n, config, true });
+    }
+
+    // Записи этого объекта поверх свежего чтения файла: то, что другие процессы
+    // добавили после load(), не теряется. Писатели по очереди берут flock на
+    // <профиль>.lock; запись идёт в уникальный временный файл (mkstemp) рядом
+    // с профилем и rename, чтобы читатель без блокировки не увидел половину профиля.
+    // false — каталог не удалось создать или он недоступен для записи.
+    bool save() const {
+        // Каталог профиля (например, ~/.cache) может ещё не существовать
+        const size_t slash = path_.rfind('/');
+        if (slash != std::string::npos && slash > 0) {
+            const std::string dir = path_.substr(0, slash);
+            if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+                return false;
+            }
+        }
+        const std::string lockPath = path_ + ".lock";
+        int lock = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lock < 0) {
+            return false;
+        }
+        while (flock(lock, LOCK_EX) != 0 && errno == EINTR) {
+        }
+        const bool saved = saveLocked();
+        ::close(lock); // снимает flock
+        return saved;
+    }
+
+private:
+    bool saveLocked() const {
+        TuningProfile current(path_);
+        current.descriptions_.insert(current.descriptions_.end(), descriptions_.begin(), descriptions_.end());
+        for (const Entry& e : entries_) {
+            if (e.stored) {
+                current.put(e);
+            }
+        }
+
+        std::ostringstream out;
+        out << "# matrix tuning profile\n";
+        std::vector<std::string> written;
+        for (const Description& d : current.descriptions_) {
+            if (std::find(written.begin(), written.end(), d.fingerprint) == written.end()) {
+                out << "# " << d.fingerprint << " " << d.text << "\n";
+                written.push_back(d.fingerprint);
+            }
+        }
+        for (const Entry& e : current.entries_) {
+            out << e.fingerprint << " " << e.type << " " << e.m << " " << e.k << " " << e.n << " "
+                << e.config.variant << " " << e.config.kernel << " " << e.config.block << " "
+                << e.config.threads << " " << e.config.medianUs << "\n";
+        }
+        const std::string text = out.str();
+
+        std::vector<char> temp(path_.begin(), path_.end());
+        const char suffix[] = ".XXXXXX";
+        temp.insert(temp.end(), suffix, suffix + sizeof(suffix));
+        int fd = mkstemp(temp.data());
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = fchmod(fd, 0644) == 0;
+        for (size_t done = 0; ok && done < text.size();) {
+            ssize_t n = ::write(fd, text.data() + done, text.size() - done);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            ok = n > 0;
+            done += ok ? static_cast<size_t>(n) : 0;
+        }
+        ok = ::close(fd) == 0 && ok;
+        if (!ok || std::rename(temp.data(), path_.c_str()) != 0) {
+            ::unlink(temp.data());
+            return false;
+        }
+        return true;
+    }
+
+    struct Entry {
+        std::string fingerprint;
+        std::string type;
+        int m;
+        int k;
+        int n;
+        TunedConfig config;
+        bool stored; // добавлена через store(), а не прочитана из файла
+    };
+
+    struct Description {
+        std::string fingerprint;
+        std::string text;
+    };
+
+    // Повреждённые строки пропускаются: такая форма просто будет настроена заново
+    void load() {
+        std::ifstream in(path_);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            if (line.compare(0, 2, "# ") == 0) {
+                std::string hash;
+                fields.ignore(2);
+                if (fields >> hash && hash.size() == 16) {
+                    std::string text;
+                    std::getline(fields >> std::ws, text);
+                    descriptions_.push_back(Description{ hash, text });
+                }
+                continue;
+            }
+            Entry e;
+            e.stored = false;
+            if (fields >> e.fingerprint >> e.type >> e.m >> e.k >> e.n >> e.config.variant
+                >> e.config.kernel >> e.config.block >> e.config.threads >> e.config.medianUs
+                && plausible(e)) {
+                entries_.push_back(e);
+            }
+        }
+    }
+
+    void put(const Entry& e) {
+        for (Entry& entry : entries_) {
+            if (entry.fingerprint == e.fingerprint && entry.type == e.type
+                && entry.m == e.m && entry.k == e.k && entry.n == e.n) {
+                entry.config = e.config;
+                entry.stored = entry.stored || e.stored;
+                return;
+            }
+        }
+        entries_.push_back(e);
+    }
+
+    // Значения из файла применяются без замеров, поэтому правленая вручную или испорченная
+    // запись не должна, например, запросить сто тысяч потоков
+    static bool plausible(const Entry& e) {
+        const int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        const char* variants[] = { "blocked", "strassen", "pool", "steal" };
+        const bool known = std::find(std::begin(variants), std::end(variants), e.config.variant) != std::end(variants);
+        // Блок 0 — разбиение под форму; Штрассену нужен положительный порог
+        const int minBlock = e.config.variant == "strassen" ? 1 : 0;
+        return known && e.m > 0 && e.k > 0 && e.n > 0
+            && e.config.block >= minBlock && e.config.block <= kMaxTunedBlock
+            && e.config.threads >= 1 && e.config.threads <= hardware * kMaxThreadsPerCpu
+            && std::isfinite(e.config.medianUs) && e.config.medianUs >= 0.0;
+    }
+
+    std::string path_;
+    std::vector<Entry> entries_;
+    std::vector<Description> descriptions_;
+};
+
+#endif // AUTOTUNE_H_
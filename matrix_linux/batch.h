@@ -0,0 +1,159 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include "cpu_features.h"
+#include "matrix.h"
+
+// Пакет из count матриц rows x cols в одном выровненном буфере.
+// Матрица b занимает matrixStride() элементов начиная с b * matrixStride(), строки
+// внутри идут подряд без дополнения; начало каждой матрицы выровнено на кэш-линию.
+template<class T>
+class MatrixBatch {
+public:
+    MatrixBatch() : count_(0), rows_(0), cols_(0) {}
+
+    // count матриц rows x cols, заполненных нулями
+    MatrixBatch(int count, int rows, int cols)
+        : count_(count), rows_(rows), cols_(cols),
+          storage_(count, Matrix<T>::paddedStride(rows * cols)) {}
+
+    // Упаковка отдельных матриц одного размера в непрерывный пакет
+    static MatrixBatch fromMatrices(const std::vector<Matrix<T>>& matrices) {
+        if (matrices.empty()) {
+            return MatrixBatch();
+        }
+        MatrixBatch batch(static_cast<int>(matrices.size()), matrices[0].rows(), matrices[0].cols());
+        for (int b = 0; b < batch.size(); b++) {
+            const Matrix<T>& m = matrices[b];
+            if (m.rows() != batch.rows() || m.cols() != batch.cols()) {
+                throw std::invalid_argument("MatrixBatch: matrices in a batch must have the same shape");
+            }
+            for (int i = 0; i < m.rows(); i++) {
+                std::memcpy(batch.data(b) + static_cast<size_t>(i) * batch.cols(), m.row(i), m.cols() * sizeof(T));
+            }
+        }
+        return batch;
+    }
+
+    int size() const { return count_; }
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int matrixStride() const { return storage_.stride(); }
+
+    T* data(int b) { return storage_.row(b); }
+    const T* data(int b) const { return storage_.row(b); }
+
+    MatrixView<T> operator[](int b) { return MatrixView<T>(data(b), rows_, cols_, cols_); }
+    MatrixView<const T> operator[](int b) const { return MatrixView<const T>(data(b), rows_, cols_, cols_); }
+
+    Matrix<T> toMatrix(int b) const {
+        Matrix<T> result(rows_, cols_);
+        for (int i = 0; i < rows_; i++) {
+            std::memcpy(result.row(i), data(b) + static_cast<size_t>(i) * cols_, cols_ * sizeof(T));
+        }
+        return result;
+    }
+
+private:
+    int count_;
+    int rows_;
+    int cols_;
+    Matrix<T> storage_; // строка b — матрица b
+};
+
+// Умножение одной маленькой матрицы: c (m x n) = a (m x k) * b (k x n), строки подряд
+template<class T, class Acc>
+using SmallKernel = void (*)(int m, int k, int n, const T* a, const T* b, Acc* c);
+
+// Общий случай: строка C копится в аккумуляторе порядка i-k-j
+template<class T, class Acc>
+void smallMultiplyGeneric(int m, int k, int n, const T* a, const T* b, Acc* c) {
+    for (int i = 0; i < m; i++) {
+        Acc* crow = c + static_cast<size_t>(i) * n;
+        std::fill(crow, crow + n, Acc());
+        for (int p = 0; p < k; p++) {
+            const Acc av = static_cast<Acc>(a[static_cast<size_t>(i) * k + p]);
+            const T* brow = b + static_cast<size_t>(p) * n;
+            for (int j = 0; j < n; j++) {
+                crow[j] += av * static_cast<Acc>(brow[j]);
+            }
+        }
+    }
+}
+
+// Квадратные N x N с N во время компиляции: все границы циклов известны, поэтому
+// векторный цикл по строке C разворачивается компилятором целиком, а сама строка
+// держится в регистрах. Тело встраивается в обёртки с разными target, так что
+// одна развёртка компилируется под SSE2, AVX2 и AVX-512.
+template<class T, class Acc, int N>
+__attribute__((always_inline)) inline void smallMultiplyFixedBody(const T* a, const T* b, Acc* c) {
+    for (int i = 0; i < N; i++) {
+        Acc row[N] = {};
+        for (int p = 0; p < N; p++) {
+            const Acc av = static_cast<Acc>(a[i * N + p]);
+            for (int j = 0; j < N; j++) {
+                row[j] += av * static_cast<Acc>(b[p * N + j]);
+            }
+        }
+        for (int j = 0; j < N; j++) {
+            c[i * N + j] = row[j];
+        }
+    }
+}
+
+template<class T, class Acc, int N>
+void smallMultiplyFixed(int, int, int, const T* a, const T* b, Acc* c) {
+    smallMultiplyFixedBody<T, Acc, N>(a, b, c);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template<class T, class Acc, int N>
+__attribute__((target("avx2,fma")))
+void smallMultiplyFixedAvx2(int, int, int, const T* a, const T* b, Acc* c) {
+    smallMultiplyFixedBody<T, Acc, N>(a, b, c);
+}
+
+template<class T, class Acc, int N>
+__attribute__((target("avx512f,avx512bw,avx512dq,fma")))
+void smallMultiplyFixedAvx512(int, int, int, const T* a, const T* b, Acc* c) {
+    smallMultiplyFixedBody<T, Acc, N>(a, b, c);
+}
+#endif
+
+// Ядро для формы m x k x n: с фиксированным размером для квадратных 8, 16, 32 и 64
+// (самый широкий набор инструкций процессора), иначе общее
+template<class T, class Acc>
+SmallKernel<T, Acc> selectSmallKernel(int m, int k, int n) {
+    if (m != k || k != n) {
+        return &smallMultiplyGeneric<T, Acc>;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    const CpuFeatures& cpu = CpuFeatures::detect();
+    const bool avx512 = cpu.avx512f && cpu.avx512bw && cpu.avx512dq;
+    const bool avx2 = cpu.avx2 && cpu.fma;
+#define BATCH_FIXED_KERNEL(N) \
+    (avx512 ? &smallMultiplyFixedAvx512<T, Acc, N> \
+        : avx2 ? &smallMultiplyFixedAvx2<T, Acc, N> : &smallMultiplyFixed<T, Acc, N>)
+#else
+#define BATCH_FIXED_KERNEL(N) (&smallMultiplyFixed<T, Acc, N>)
+#endif
+    switch (n) {
+    case 8:
+        return BATCH_FIXED_KERNEL(8);
+    case 16:
+        return BATCH_FIXED_KERNEL(16);
+    case 32:
+        return BATCH_FIXED_KERNEL(32);
+    case 64:
+        return BATCH_FIXED_KERNEL(64);
+    default:
+        return &smallMultiplyGeneric<T, Acc>;
+    }
+#undef BATCH_FIXED_KERNEL
+}
+
+#endif // BATCH_H_
@@ -0,0 +1,259 @@
+#ifndef CHAIN_H_
+#define CHAIN_H_
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gemm.h"
+#include "matrix.h"
+#include "thread_pool.h"
+
+// Порядок умножения цепочки A_1 * A_2 * ... * A_n, где A_i имеет размер dims[i-1] x dims[i].
+// Стоимость произведения p x q на q x r — 2*p*q*r операций; оптимальная расстановка
+// скобок находится динамическим программированием за O(n^3).
+struct ChainPlan {
+    std::vector<int> dims;      // n + 1 размеров
+    std::vector<int> split;     // split[i*n + j]: (A_i..A_s)(A_s+1..A_j) при s = split, нумерация с 0
+    double flops;               // операций в оптимальном порядке
+    double leftToRightFlops;    // операций при умножении слева направо
+
+    ChainPlan() : flops(0.0), leftToRightFlops(0.0) {}
+
+    int factors() const { return static_cast<int>(dims.size()) - 1; }
+    int splitAt(int i, int j) const { return split[static_cast<size_t>(i) * factors() + j]; }
+
+    // Расстановка скобок, например "((A1 A2) A3)"
+    std::string order() const {
+        return factors() > 0 ? orderOf(0, factors() - 1) : std::string();
+    }
+
+private:
+    std::string orderOf(int i, int j) const {
+        if (i == j) {
+            return "A" + std::to_string(i + 1);
+        }
+        int s = splitAt(i, j);
+        return "(" + orderOf(i, s) + " " + orderOf(s + 1, j) + ")";
+    }
+};
+
+inline double chainProductFlops(double p, double q, double r) {
+    return 2.0 * p * q * r;
+}
+
+inline ChainPlan planChain(const std::vector<int>& dims) {
+    if (dims.size() < 2) {
+        throw std::invalid_argument("planChain: a chain needs at least one factor");
+    }
+    ChainPlan plan;
+    plan.dims = dims;
+    const int n = plan.factors();
+    plan.split.assign(static_cast<size_t>(n) * n, 0);
+    std::vector<double> cost(static_cast<size_t>(n) * n, 0.0);
+    for (int length = 2; length <= n; length++) {
+        for (int i = 0; i + length - 1 < n; i++) {
+            const int j = i + length - 1;
+            double best = -1.0;
+            for (int s = i; s < j; s++) {
+                double c = cost[static_cast<size_t>(i) * n + s] + cost[static_cast<size_t>(s + 1) * n + j]
+                    + chainProductFlops(dims[i], dims[s + 1], dims[j + 1]);
+                if (best < 0.0 || c < best) {
+                    best = c;
+                    plan.split[static_cast<size_t>(i) * n + j] = s;
+                }
+            }
+            cost[static_cast<size_t>(i) * n + j] = best;
+        }
+    }
+    plan.flops = cost[n - 1];
+    plan.leftToRightFlops = 0.0;
+    for (int s = 1; s < n; s++) {
+        plan.leftToRightFlops += chainProductFlops(dims[0], dims[s], dims[s + 1]);
+    }
+    return plan;
+}
+
+// Буферы промежуточных произведений (слоты). Какой слот получает каждый узел
+// цепочки, решает ChainEvaluator заранее; буфер слота растёт только если ему нужно
+// больше места, поэтому повторное умножение цепочек тех же размеров память не выделяет.
+template<class Acc>
+class ChainBuffers {
+public:
+    ChainBuffers() : allocations_(0) {}
+
+    // Слот slot вмещает не меньше elements элементов
+    void reserve(int slot, size_t elements) {
+        if (slot >= static_cast<int>(buffers_.size())) {
+            buffers_.resize(slot + 1);
+        }
+        if (capacity(slot) < elements) {
+            const int stride = Matrix<Acc>::paddedStride(1);
+            buffers_[slot] = Matrix<Acc>::uninitialized(static_cast<int>((elements + stride - 1) / stride), 1);
+            allocations_++;
+        }
+    }
+
+    size_t capacity(int slot) const {
+        if (slot >= static_cast<int>(buffers_.size())) {
+            return 0;
+        }
+        return static_cast<size_t>(buffers_[slot].rows()) * buffers_[slot].stride();
+    }
+
+    // Представление rows x cols (строки дополнены до кэш-линии) в начале слота
+    MatrixView<Acc> view(int slot, int rows, int cols) {
+        return MatrixView<Acc>(buffers_[slot].data(), rows, cols, Matrix<Acc>::paddedStride(cols));
+    }
+
+    static size_t elements(int rows, int cols) {
+        return static_cast<size_t>(rows) * Matrix<Acc>::paddedStride(cols);
+    }
+
+    int slots() const { return static_cast<int>(buffers_.size()); }
+    // Сколько раз буфер пришлось выделить (за всё время)
+    long long allocations() const { return allocations_; }
+
+private:
+    std::vector<Matrix<Acc>> buffers_;
+    long long allocations_;
+};
+
+// Вычисление цепочки по плану. Независимые подцепочки (обе половины узла —
+// произведения) считаются одновременно через parallelFor на два индекса,
+// каждое произведение режется на плитки по строкам и столбцам C на том же пуле.
+// Слоты назначаются до вычисления: результат узла занимает слот с момента, когда
+// посчитаны его половины, до конца произведения родителя. Слот нельзя дать узлу,
+// если он может быть занят в это время: слоты половин, слоты предков-соседей и,
+// при одновременном счёте, все слоты соседнего поддерева.
+template<class P, class Acc>
+class ChainEvaluator {
+public:
+    ChainEvaluator(const ChainPlan& plan, const std::vector<MatrixView<const Acc>>& factors,
+        const MicroKernel<P, Acc>& kernel, const BlockingParams& blocking, ThreadPool& pool,
+        ChainBuffers<Acc>& buffers)
+        : plan_(plan), factors_(factors), kernel_(kernel), blocking_(blocking), pool_(pool), buffers_(buffers),
+          slot_(static_cast<size_t>(plan.factors()) * plan.factors(), -1) {}
+
+    Matrix<Acc> run() {
+        const int n = plan_.factors();
+        Matrix<Acc> C = Matrix<Acc>::uninitialized(plan_.dims[0], plan_.dims[n]);
+        if (n == 1) {
+            for (int i = 0; i < C.rows(); i++) {
+                std::copy(factors_[0].row(i), factors_[0].row(i) + C.cols(), C.row(i));
+            }
+            return C;
+        }
+        std::vector<size_t> capacities;
+        std::vector<int> used;
+        assignChildren(0, n - 1, std::vector<int>(), capacities, used);
+        for (int slot = 0; slot < static_cast<int>(capacities.size()); slot++) {
+            buffers_.reserve(slot, capacities[slot]);
+        }
+        computeInto(0, n - 1, C.view());
+        return C;
+    }
+
+private:
+    bool concurrent(int i, int j) const {
+        const int s = plan_.splitAt(i, j);
+        return s > i && s + 1 < j;
+    }
+
+    int& slotOf(int i, int j) { return slot_[static_cast<size_t>(i) * plan_.factors() + j]; }
+
+    // Слоты половин узла (i, j); busy — слоты, которые могут быть заняты всё это время.
+    // used получает все слоты поддерева.
+    void assignChildren(int i, int j, const std::vector<int>& busy, std::vector<size_t>& capacities,
+        std::vector<int>& used) {
+        const int s = plan_.splitAt(i, j);
+        std::vector<int> leftUsed;
+        assignNode(i, s, busy, capacities, leftUsed);
+        std::vector<int> rightBusy = busy;
+        if (concurrent(i, j)) {
+            rightBusy.insert(rightBusy.end(), leftUsed.begin(), leftUsed.end());
+        } else if (s > i) {
+            rightBusy.push_back(slotOf(i, s));
+        }
+        std::vector<int> rightUsed;
+        assignNode(s + 1, j, rightBusy, capacities, rightUsed);
+        used.insert(used.end(), leftUsed.begin(), leftUsed.end());
+        used.insert(used.end(), rightUsed.begin(), rightUsed.end());
+    }
+
+    void assignNode(int i, int j, const std::vector<int>& busy, std::vector<size_t>& capacities,
+        std::vector<int>& used) {
+        if (i == j) {
+            return;
+        }
+        assignChildren(i, j, busy, capacities, used);
+        const int s = plan_.splitAt(i, j);
+        std::vector<int> excluded = busy;
+        if (s > i) {
+            excluded.push_back(slotOf(i, s));
+        }
+        if (s + 1 < j) {
+            excluded.push_back(slotOf(s + 1, j));
+        }
+        // Из свободных слотов — наименьший подходящий, иначе наибольший (он вырастет)
+        const size_t need = ChainBuffers<Acc>::elements(plan_.dims[i], plan_.dims[j + 1]);
+        int best = -1;
+        for (int slot = 0; slot < static_cast<int>(capacities.size()); slot++) {
+            if (std::find(excluded.begin(), excluded.end(), slot) != excluded.end()) {
+                continue;
+            }
+            const bool fits = capacities[slot] >= need;
+            const bool bestFits = best >= 0 && capacities[best] >= need;
+            if (best < 0 || (fits && (!bestFits || capacities[slot] < capacities[best]))
+                || (!fits && !bestFits && capacities[slot] > capacities[best])) {
+                best = slot;
+            }
+        }
+        if (best < 0) {
+            best = static_cast<int>(capacities.size());
+            capacities.push_back(0);
+        }
+        capacities[best] = std::max(capacities[best], need);
+        slotOf(i, j) = best;
+        used.push_back(best);
+    }
+
+    MatrixView<const Acc> operand(int i, int j) {
+        if (i == j) {
+            return factors_[i];
+        }
+        MatrixView<Acc> target = buffers_.view(slotOf(i, j), plan_.dims[i], plan_.dims[j + 1]);
+        computeInto(i, j, target);
+        return target;
+    }
+
+    // target = A_i * ... * A_j
+    void computeInto(int i, int j, MatrixView<Acc> target) {
+        const int s = plan_.splitAt(i, j);
+        MatrixView<const Acc> left;
+        MatrixView<const Acc> right;
+        if (concurrent(i, j)) {
+            pool_.parallelFor(2, [&](int side) {
+                if (side == 0) {
+                    left = operand(i, s);
+                } else {
+                    right = operand(s + 1, j);
+                }
+            });
+        } else {
+            left = operand(i, s);
+            right = operand(s + 1, j);
+        }
+        gemmParallel(kernel_, blocking_, left, right, target, pool_);
+    }
+
+    const ChainPlan& plan_;
+    const std::vector<MatrixView<const Acc>>& factors_;
+    const MicroKernel<P, Acc>& kernel_;
+    const BlockingParams& blocking_;
+    ThreadPool& pool_;
+    ChainBuffers<Acc>& buffers_;
+    std::vector<int> slot_; // слот результата узла (i, j), i < j
+};
+
+#endif // CHAIN_H_
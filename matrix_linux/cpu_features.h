@@ -0,0 +1,107 @@
+#ifndef CPU_FEATURES_H_
+#define CPU_FEATURES_H_
+
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// Наборы инструкций, доступные процессору и включённые ОС (по cpuid и xgetbv)
+struct CpuFeatures {
+    bool sse41;
+    bool avx2;
+    bool fma;
+    bool avx512f;
+    bool avx512bw;
+    bool avx512dq;
+    bool avx512vnni;
+    bool avxvnni;
+
+    static const CpuFeatures& detect() {
+        static const CpuFeatures features = query();
+        return features;
+    }
+
+private:
+#if defined(__x86_64__) || defined(__i386__)
+    static unsigned long long xgetbv0() {
+        unsigned int eax = 0;
+        unsigned int edx = 0;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+    }
+
+    static CpuFeatures query() {
+        CpuFeatures f = {};
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            return f;
+        }
+        f.sse41 = (ecx & bit_SSE4_1) != 0;
+        bool osxsave = (ecx & bit_OSXSAVE) != 0;
+        bool fma = (ecx & bit_FMA) != 0;
+
+        // Регистры YMM/ZMM должны сохраняться ОС при переключении контекста
+        unsigned long long xcr0 = osxsave ? xgetbv0() : 0;
+        bool ymmState = (xcr0 & 0x6) == 0x6;
+        bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            f.avx2 = ymmState && (ebx & bit_AVX2) != 0;
+            f.fma = f.avx2 && fma;
+            f.avx512f = zmmState && (ebx & bit_AVX512F) != 0;
+            f.avx512bw = f.avx512f && (ebx & bit_AVX512BW) != 0;
+            f.avx512dq = f.avx512f && (ebx & bit_AVX512DQ) != 0;
+            f.avx512vnni = f.avx512bw && (ecx & (1u << 11)) != 0;
+        }
+        if (__get_cpuid_count(7, 1, &eax, &ebx, &ecx, &edx)) {
+            f.avxvnni = f.avx2 && (eax & (1u << 4)) != 0;
+        }
+        return f;
+    }
+#else
+    static CpuFeatures query() {
+        return CpuFeatures();
+    }
+#endif
+};
+
+// Модель процессора: строка бренда cpuid (листья 0x80000002..4),
+// иначе поле "model name" из /proc/cpuinfo
+inline std::string cpuModelName() {
+    std::string name;
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int regs[12] = {};
+    if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004) {
+        for (unsigned int leaf = 0; leaf < 3; leaf++) {
+            __get_cpuid(0x80000002 + leaf, &regs[leaf * 4], &regs[leaf * 4 + 1],
+                &regs[leaf * 4 + 2], &regs[leaf * 4 + 3]);
+        }
+        char brand[sizeof(regs) + 1] = {};
+        std::memcpy(brand, regs, sizeof(regs));
+        name = brand;
+    }
+#endif
+    if (name.empty()) {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.compare(0, 10, "model name") == 0) {
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    name = line.substr(colon + 1);
+                }
+                break;
+            }
+        }
+    }
+    // Бренд дополняется пробелами: убираем их по краям
+    size_t first = name.find_first_not_of(' ');
+    size_t last = name.find_last_not_of(' ');
+    return first == std::string::npos ? std::string("unknown") : name.substr(first, last - first + 1);
+}
+
+#endif // CPU_FEATURES_H_
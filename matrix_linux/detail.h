@@ -0,0 +1,40 @@
+#ifndef DETAIL_H_
+#define DETAIL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include "thread_pool.h"
+
+// Вспомогательные функции, общие для нескольких заголовков
+namespace detail {
+
+// Приращение состояния SplitMix64 (дробная часть золотого сечения)
+const uint64_t kSplitMixGamma = 0x9e3779b97f4a7c15ull;
+
+// Финальное перемешивание SplitMix64: биекция, каждый бит входа влияет на все биты выхода
+inline uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Один шаг SplitMix64 из состояния x
+inline uint64_t splitMix64(uint64_t x) {
+    return mix64(x + kSplitMixGamma);
+}
+
+// Полосы для parallelFor: частей в несколько раз больше потоков, чтобы неровные
+// по стоимости полосы распределялись динамически через счётчик пула
+inline int chunkCount(long long count, const ThreadPool& pool) {
+    return static_cast<int>(std::max(1LL, std::min(count, static_cast<long long>(pool.size() + 1) * 4)));
+}
+
+// Начало части chunk из chunks равных частей count элементов; конец — начало chunk + 1
+template<class I>
+inline I chunkBegin(I count, int chunks, int chunk) {
+    return static_cast<I>(static_cast<long long>(count) * chunk / chunks);
+}
+
+} // namespace detail
+
+#endif // DETAIL_H_
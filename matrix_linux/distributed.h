@@ -0,0 +1,791 @@
+#ifndef DISTRIBUTED_H_
+#define DISTRIBUTED_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <functional>
+#include <linux/futex.h>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "gemm.h"
+#include "matrix.h"
+
+// Транспорт между процессами распределённого умножения
+enum class DistributedTransport {
+    SharedMemory, // кольцевые буферы в общей памяти POSIX (shm_open), ожидание на futex
+    UnixSocket    // пары сокетов домена Unix (socketpair)
+};
+
+inline const char* distributedTransportName(DistributedTransport transport) {
+    return transport == DistributedTransport::UnixSocket ? "socket" : "shm";
+}
+
+// Двусторонний поток байт между стороной 0 и стороной 1. Создаётся до fork();
+// после него каждый процесс оставляет себе свою сторону (keep) или отказывается
+// от канала (drop). Отправка и приём одной стороны могут идти из разных потоков.
+// Сетевой транспорт для нескольких узлов реализует этот же интерфейс.
+class Link {
+public:
+    virtual ~Link() {}
+
+    virtual void send(int side, const void* data, size_t bytes) = 0;
+    virtual void receive(int side, void* data, size_t bytes) = 0;
+    virtual void keep(int side) = 0;
+    virtual void drop() = 0;
+
+    // Проверка, что другая сторона жива; вызывается, пока ожидание затягивается
+    void setAlive(std::function<bool()> alive) { alive_ = std::move(alive); }
+
+protected:
+    static const int kPollMs = 100;
+
+    void checkAlive() const {
+        if (alive_ && !alive_()) {
+            throw std::runtime_error("Link: peer process failed");
+        }
+    }
+
+private:
+    std::function<bool()> alive_;
+};
+
+// Канал на паре сокетов домена Unix
+class SocketLink : public Link {
+public:
+    SocketLink() {
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds_) != 0) {
+            throw std::runtime_error(std::string("SocketLink: socketpair failed: ") + std::strerror(errno));
+        }
+    }
+
+    ~SocketLink() override { drop(); }
+
+    void send(int side, const void* data, size_t bytes) override {
+        const char* ptr = static_cast<const char*>(data);
+        while (bytes > 0) {
+            wait(side, POLLOUT);
+            ssize_t sent = ::send(fds_[side], ptr, bytes, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (sent < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("SocketLink: send failed: ") + std::strerror(errno));
+            }
+            ptr += sent;
+            bytes -= static_cast<size_t>(sent);
+        }
+    }
+
+    void receive(int side, void* data, size_t bytes) override {
+        char* ptr = static_cast<char*>(data);
+        while (bytes > 0) {
+            wait(side, POLLIN);
+            ssize_t got = ::recv(fds_[side], ptr, bytes, MSG_DONTWAIT);
+            if (got == 0) {
+                throw std::runtime_error("SocketLink: peer closed the connection");
+            }
+            if (got < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("SocketLink: recv failed: ") + std::strerror(errno));
+            }
+            ptr += got;
+            bytes -= static_cast<size_t>(got);
+        }
+    }
+
+    // Сокет другой стороны закрывается, чтобы её завершение было видно как конец потока
+    void keep(int side) override { close(1 - side); }
+
+    void drop() override {
+        close(0);
+        close(1);
+    }
+
+private:
+    void wait(int side, short events) const {
+        pollfd p = { fds_[side], events, 0 };
+        while (poll(&p, 1, kPollMs) == 0) {
+            checkAlive();
+        }
+    }
+
+    void close(int side) {
+        if (fds_[side] >= 0) {
+            ::close(fds_[side]);
+            fds_[side] = -1;
+        }
+    }
+
+    int fds_[2];
+};
+
+// Канал на общей памяти POSIX: два кольцевых буфера по capacity байт, по одному
+// на направление. head и tail — счётчики записанных и прочитанных байт по модулю 2^32;
+// ожидающая сторона спит на futex того счётчика, который двигает другая.
+class SharedMemoryLink : public Link {
+public:
+    explicit SharedMemoryLink(size_t capacity = size_t(1) << 20) : capacity_(capacity), base_(nullptr) {
+        if (capacity_ == 0 || (capacity_ & (capacity_ - 1)) != 0 || capacity_ > (size_t(1) << 30)) {
+            throw std::invalid_argument("SharedMemoryLink: capacity must be a power of two up to 1 GiB");
+        }
+        static std::atomic<unsigned> counter(0);
+        const std::string name = "/matrix-link-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            fail("shm_open failed");
+        }
+        // Имя нужно только для создания: отображение наследуют процессы после fork()
+        shm_unlink(name.c_str());
+        if (ftruncate(fd, static_cast<off_t>(mappedBytes())) != 0) {
+            ::close(fd);
+            fail("ftruncate failed");
+        }
+        void* ptr = mmap(nullptr, mappedBytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED) {
+            fail("mmap failed");
+        }
+        base_ = static_cast<char*>(ptr);
+        for (int direction = 0; direction < 2; direction++) {
+            new (ring(direction)) Ring();
+        }
+    }
+
+    ~SharedMemoryLink() override { drop(); }
+
+    void send(int side, const void* data, size_t bytes) override {
+        Ring* r = ring(side);
+        char* buffer = payload(side);
+        const char* ptr = static_cast<const char*>(data);
+        while (bytes > 0) {
+            const uint32_t head = r->head.load(std::memory_order_relaxed);
+            uint32_t tail = r->tail.load(std::memory_order_acquire);
+            while (head - tail == capacity_) {
+                wait(r->tail, tail);
+                tail = r->tail.load(std::memory_order_acquire);
+            }
+            const size_t offset = head & (capacity_ - 1);
+            const size_t chunk = std::min({ bytes, capacity_ - (head - tail), capacity_ - offset });
+            std::memcpy(buffer + offset, ptr, chunk);
+            r->head.store(head + static_cast<uint32_t>(chunk), std::memory_order_release);
+            wake(r->head);
+            ptr += chunk;
+            bytes -= chunk;
+        }
+    }
+
+    void receive(int side, void* data, size_t bytes) override {
+        Ring* r = ring(1 - side);
+        const char* buffer = payload(1 - side);
+        char* ptr = static_cast<char*>(data);
+        while (bytes > 0) {
+            const uint32_t tail = r->tail.load(std::memory_order_relaxed);
+            uint32_t head = r->head.load(std::memory_order_acquire);
+            while (head == tail) {
+                wait(r->head, head);
+                head = r->head.load(std::memory_order_acquire);
+            }
+            const size_t offset = tail & (capacity_ - 1);
+            const size_t chunk = std::min({ bytes, static_cast<size_t>(head - tail), capacity_ - offset });
+            std::memcpy(ptr, buffer + offset, chunk);
+            r->tail.store(tail + static_cast<uint32_t>(chunk), std::memory_order_release);
+            wake(r->tail);
+            ptr += chunk;
+            bytes -= chunk;
+        }
+    }
+
+    void keep(int) override {}
+
+    void drop() override {
+        if (base_) {
+            munmap(base_, mappedBytes());
+            base_ = nullptr;
+        }
+    }
+
+private:
+    // Заголовок кольца: счётчики в разных кэш-линиях, пишут их разные процессы
+    struct Ring {
+        alignas(64) std::atomic<uint32_t> head;
+        alignas(64) std::atomic<uint32_t> tail;
+
+        Ring() : head(0), tail(0) {}
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "futex needs lock-free 32-bit atomics");
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32 bits");
+
+    [[noreturn]] static void fail(const std::string& what) {
+        throw std::runtime_error("SharedMemoryLink: " + what + ": " + std::strerror(errno));
+    }
+
+    size_t mappedBytes() const { return 2 * (sizeof(Ring) + capacity_); }
+    Ring* ring(int direction) const {
+        return reinterpret_cast<Ring*>(base_ + direction * (sizeof(Ring) + capacity_));
+    }
+    char* payload(int direction) const { return reinterpret_cast<char*>(ring(direction)) + sizeof(Ring); }
+
+    // Сон, пока word == expected; futex без FUTEX_PRIVATE_FLAG, так как слово в общей памяти
+    void wait(std::atomic<uint32_t>& word, uint32_t expected) const {
+        const timespec timeout = { 0, kPollMs * 1000000L };
+        if (syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0) != 0
+            && errno == ETIMEDOUT) {
+            checkAlive();
+        }
+    }
+
+    static void wake(std::atomic<uint32_t>& word) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    size_t capacity_;
+    char* base_;
+};
+
+inline std::unique_ptr<Link> makeLink(DistributedTransport transport) {
+    if (transport == DistributedTransport::UnixSocket) {
+        return std::unique_ptr<Link>(new SocketLink());
+    }
+    return std::unique_ptr<Link>(new SharedMemoryLink());
+}
+
+// Блочно-циклическое распределение n индексов блоками по block между procs владельцами:
+// блок b принадлежит b % procs и лежит у него с локального смещения (b / procs) * block
+struct BlockCyclic {
+    int n;
+    int block;
+    int procs;
+
+    int blocks() const { return (n + block - 1) / block; }
+    int blockSize(int b) const { return std::min(block, n - b * block); }
+    int owner(int b) const { return b % procs; }
+    int localOffset(int b) const { return b / procs * block; }
+
+    int localSize(int proc) const {
+        int size = 0;
+        for (int b = proc; b < blocks(); b += procs) {
+            size += blockSize(b);
+        }
+        return size;
+    }
+};
+
+// Решётка процессов rows x cols, ближайшая к квадратной
+struct ProcessGrid {
+    int rows;
+    int cols;
+
+    static ProcessGrid forWorkers(int workers) {
+        int rows = 1;
+        for (int r = 1; r * r <= workers; r++) {
+            if (workers % r == 0) {
+                rows = r;
+            }
+        }
+        return ProcessGrid{ rows, workers / rows };
+    }
+};
+
+struct DistributedOptions {
+    int workers;                    // процессов-рабочих, решётка ProcessGrid::forWorkers
+    int block;                      // размер блока распределения и шаг SUMMA по K
+    DistributedTransport transport;
+
+    DistributedOptions() : workers(4), block(64), transport(DistributedTransport::SharedMemory) {}
+};
+
+// Время одного рабочего (мкс от его запуска) и объём его обменов
+struct DistributedWorkerStats {
+    int worker;
+    int gridRow;
+    int gridCol;
+    double scatterUs; // приём своих блоков A и B от координатора
+    double computeUs; // локальные умножения панелей
+    double commUs;    // приём панелей в потоке связи
+    double sendUs;    // рассылка своих панелей в потоке отправки
+    double waitUs;    // счёт ждал ещё не пришедших панелей
+    double gatherUs;  // отправка блока C координатору
+    double totalUs;
+    long long bytesSent;
+    long long bytesReceived;
+};
+
+// Отчёт последнего распределённого умножения
+struct DistributedReport {
+    DistributedTransport transport;
+    int gridRows;
+    int gridCols;
+    int block;
+    int steps;        // шагов SUMMA (блоков по K)
+    double totalUs;   // у координатора: от запуска процессов до сборки C
+    std::vector<DistributedWorkerStats> workers;
+
+    DistributedReport()
+        : transport(DistributedTransport::SharedMemory), gridRows(0), gridCols(0), block(0), steps(0), totalUs(0.0) {}
+
+    // Доля приёма панелей, скрытая за счётом: 1 — счёт ни разу не ждал связи
+    double overlap() const {
+        double comm = 0.0;
+        double wait = 0.0;
+        for (const DistributedWorkerStats& w : workers) {
+            comm += w.commUs;
+            wait += w.waitUs;
+        }
+        return comm > 0.0 ? std::max(0.0, 1.0 - wait / comm) : 1.0;
+    }
+};
+
+namespace distributed_detail {
+
+inline double elapsedUs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Для каждого своего блока: f(глобальное начало, локальное начало, размер)
+template<class F>
+void forEachOwned(const BlockCyclic& layout, int proc, F f) {
+    for (int b = proc; b < layout.blocks(); b += layout.procs) {
+        f(b * layout.block, layout.localOffset(b), layout.blockSize(b));
+    }
+}
+
+// Локальная часть матрицы (строки rows.proc, столбцы cols.proc) подряд, по строкам
+template<class T>
+void packLocal(MatrixView<const T> global, const BlockCyclic& rows, int rowProc,
+    const BlockCyclic& cols, int colProc, std::vector<T>& out) {
+    const int localCols = cols.localSize(colProc);
+    out.resize(static_cast<size_t>(rows.localSize(rowProc)) * localCols);
+    forEachOwned(rows, rowProc, [&](int gi, int li, int ni) {
+        forEachOwned(cols, colProc, [&](int gj, int lj, int nj) {
+            for (int i = 0; i < ni; i++) {
+                std::memcpy(out.data() + static_cast<size_t>(li + i) * localCols + lj, global.row(gi + i) + gj,
+                    nj * sizeof(T));
+            }
+        });
+    });
+}
+
+template<class T>
+void unpackLocal(const std::vector<T>& in, const BlockCyclic& rows, int rowProc,
+    const BlockCyclic& cols, int colProc, MatrixView<T> global) {
+    const int localCols = cols.localSize(colProc);
+    forEachOwned(rows, rowProc, [&](int gi, int li, int ni) {
+        forEachOwned(cols, colProc, [&](int gj, int lj, int nj) {
+            for (int i = 0; i < ni; i++) {
+                std::memcpy(global.row(gi + i) + gj, in.data() + static_cast<size_t>(li + i) * localCols + lj,
+                    nj * sizeof(T));
+            }
+        });
+    });
+}
+
+// Столбцы [col, col + width) локальной матрицы rows x stride подряд
+template<class T>
+void packColumns(const std::vector<T>& local, int rows, int stride, int col, int width, std::vector<T>& out) {
+    out.resize(static_cast<size_t>(rows) * width);
+    for (int i = 0; i < rows; i++) {
+        std::memcpy(out.data() + static_cast<size_t>(i) * width, local.data() + static_cast<size_t>(i) * stride + col,
+            width * sizeof(T));
+    }
+}
+
+// Дочерние процессы-рабочие: при выходе из области видимости (в том числе по
+// исключению) ещё работающие убиваются и все собираются waitpid
+class Children {
+public:
+    ~Children() {
+        for (size_t w = 0; w < pids_.size(); w++) {
+            if (!reaped_[w]) {
+                kill(pids_[w], SIGKILL);
+                waitpid(pids_[w], nullptr, 0);
+            }
+        }
+    }
+
+    void add(pid_t pid) {
+        pids_.push_back(pid);
+        reaped_.push_back(false);
+    }
+
+    // false — какой-то рабочий завершился с ошибкой
+    bool healthy() {
+        for (size_t w = 0; w < pids_.size(); w++) {
+            int status = 0;
+            if (!reaped_[w] && waitpid(pids_[w], &status, WNOHANG) == pids_[w]) {
+                reaped_[w] = true;
+                failed_ = failed_ || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+            }
+        }
+        return !failed_;
+    }
+
+    // Ожидание завершения всех; false — кто-то завершился с ошибкой
+    bool join() {
+        for (size_t w = 0; w < pids_.size(); w++) {
+            int status = 0;
+            if (!reaped_[w] && waitpid(pids_[w], &status, 0) == pids_[w]) {
+                reaped_[w] = true;
+                failed_ = failed_ || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+            }
+        }
+        return !failed_;
+    }
+
+private:
+    std::vector<pid_t> pids_;
+    std::vector<bool> reaped_;
+    bool failed_ = false;
+};
+
+// Каналы одного запуска: координатор (сторона 0) с каждым рабочим (сторона 1) и
+// рабочие одной строки или одного столбца решётки между собой (меньший номер — сторона 0)
+struct Links {
+    std::vector<std::unique_ptr<Link>> coordinator;
+    std::vector<std::unique_ptr<Link>> peers; // [a * workers + b] при a < b
+    int workers;
+
+    Links(DistributedTransport transport, const ProcessGrid& grid) : workers(grid.rows * grid.cols) {
+        peers.resize(static_cast<size_t>(workers) * workers);
+        for (int w = 0; w < workers; w++) {
+            coordinator.push_back(makeLink(transport));
+        }
+        for (int a = 0; a < workers; a++) {
+            for (int b = a + 1; b < workers; b++) {
+                if (a / grid.cols == b / grid.cols || a % grid.cols == b % grid.cols) {
+                    peers[static_cast<size_t>(a) * workers + b] = makeLink(transport);
+                }
+            }
+        }
+    }
+
+    // Канал рабочего self с рабочим other и сторона self в нём
+    Link& peer(int self, int other, int& side) const {
+        side = self < other ? 0 : 1;
+        return *peers[static_cast<size_t>(std::min(self, other)) * workers + std::max(self, other)];
+    }
+
+    // В процессе рабочего self остаются только его каналы
+    void keepWorker(int self) {
+        for (int w = 0; w < workers; w++) {
+            if (w == self) {
+                coordinator[w]->keep(1);
+            } else {
+                coordinator[w]->drop();
+            }
+        }
+        for (int a = 0; a < workers; a++) {
+            for (int b = a + 1; b < workers; b++) {
+                Link* link = peers[static_cast<size_t>(a) * workers + b].get();
+                if (!link) {
+                    continue;
+                }
+                if (a == self || b == self) {
+                    link->keep(a == self ? 0 : 1);
+                } else {
+                    link->drop();
+                }
+            }
+        }
+    }
+
+    void keepCoordinator() {
+        for (std::unique_ptr<Link>& link : coordinator) {
+            link->keep(0);
+        }
+        for (std::unique_ptr<Link>& link : peers) {
+            if (link) {
+                link->drop();
+            }
+        }
+    }
+};
+
+// Рабочий (p, q) решётки: принимает свои блоки A и B, выполняет шаги SUMMA и
+// возвращает свой блок C. На шаге s владелец столбца панели A (столбец решётки s % cols)
+// рассылает её по своей строке решётки, владелец строки панели B (s % rows) — по
+// своему столбцу. Поток отправки рассылает свои панели всех шагов подряд, поток
+// приёма заполняет два буфера панелей: пока считается шаг s, приходит шаг s + 1.
+template<class T, class P, class Acc>
+void runWorker(const MicroKernel<P, Acc>& kernel, const BlockingParams& params, const Links& links,
+    const ProcessGrid& grid, int self, const BlockCyclic& rowsC, const BlockCyclic& colsC,
+    const BlockCyclic& colsA, const BlockCyclic& rowsB) {
+    const auto start = std::chrono::steady_clock::now();
+    DistributedWorkerStats stats = {};
+    stats.worker = self;
+    stats.gridRow = self / grid.cols;
+    stats.gridCol = self % grid.cols;
+    const int p = stats.gridRow;
+    const int q = stats.gridCol;
+    Link& coordinator = *links.coordinator[self];
+
+    const int localRows = rowsC.localSize(p);
+    const int localCols = colsC.localSize(q);
+    const int localK = colsA.localSize(q);
+    std::vector<T> localA(static_cast<size_t>(localRows) * localK);
+    std::vector<T> localB(static_cast<size_t>(rowsB.localSize(p)) * localCols);
+    coordinator.receive(1, localA.data(), localA.size() * sizeof(T));
+    coordinator.receive(1, localB.data(), localB.size() * sizeof(T));
+    stats.bytesReceived += (localA.size() + localB.size()) * sizeof(T);
+    stats.scatterUs = elapsedUs(start);
+
+    const int steps = colsA.blocks();
+    std::vector<T> panelA[2];
+    std::vector<T> panelB[2];
+    std::mutex mutex;
+    std::condition_variable changed;
+    int received = 0;  // шагов, чьи панели уже в буферах
+    int computed = 0;  // шагов, посчитанных и освободивших буфер
+    bool failed = false;
+    std::exception_ptr error;
+    std::atomic<long long> bytesSent(0);
+    std::atomic<long long> bytesReceived(0);
+
+    auto guarded = [&](auto body) {
+        return [&, body]() {
+            try {
+                body();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+                changed.notify_all();
+            }
+        };
+    };
+
+    std::thread sender(guarded([&]() {
+        const auto begin = std::chrono::steady_clock::now();
+        std::vector<T> packed;
+        for (int s = 0; s < steps; s++) {
+            const int kb = colsA.blockSize(s);
+            if (colsA.owner(s) == q && grid.cols > 1) {
+                packColumns(localA, localRows, localK, colsA.localOffset(s), kb, packed);
+                for (int other = 0; other < grid.cols; other++) {
+                    if (other != q) {
+                        int side = 0;
+                        links.peer(self, p * grid.cols + other, side).send(side, packed.data(), packed.size() * sizeof(T));
+                        bytesSent += packed.size() * sizeof(T);
+                    }
+                }
+            }
+            if (rowsB.owner(s) == p && grid.rows > 1) {
+                const T* rows = localB.data() + static_cast<size_t>(rowsB.localOffset(s)) * localCols;
+                for (int other = 0; other < grid.rows; other++) {
+                    if (other != p) {
+                        int side = 0;
+                        links.peer(self, other * grid.cols + q, side).send(side, rows,
+                            static_cast<size_t>(kb) * localCols * sizeof(T));
+                        bytesSent += static_cast<long long>(kb) * localCols * sizeof(T);
+                    }
+                }
+            }
+        }
+        stats.sendUs = elapsedUs(begin);
+    }));
+
+    std::thread receiver(guarded([&]() {
+        for (int s = 0; s < steps; s++) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return failed || computed >= s - 1; });
+                if (failed) {
+                    return;
+                }
+            }
+            const auto begin = std::chrono::steady_clock::now();
+            const int kb = colsA.blockSize(s);
+            std::vector<T>& a = panelA[s % 2];
+            std::vector<T>& b = panelB[s % 2];
+            const int ownerA = colsA.owner(s);
+            if (ownerA == q) {
+                packColumns(localA, localRows, localK, colsA.localOffset(s), kb, a);
+            } else {
+                a.resize(static_cast<size_t>(localRows) * kb);
+                int side = 0;
+                links.peer(self, p * grid.cols + ownerA, side).receive(side, a.data(), a.size() * sizeof(T));
+                bytesReceived += a.size() * sizeof(T);
+            }
+            const int ownerB = rowsB.owner(s);
+            if (ownerB == p) {
+                const T* rows = localB.data() + static_cast<size_t>(rowsB.localOffset(s)) * localCols;
+                b.assign(rows, rows + static_cast<size_t>(kb) * localCols);
+            } else {
+                b.resize(static_cast<size_t>(kb) * localCols);
+                int side = 0;
+                links.peer(self, ownerB * grid.cols + q, side).receive(side, b.data(), b.size() * sizeof(T));
+                bytesReceived += b.size() * sizeof(T);
+            }
+            stats.commUs += elapsedUs(begin);
+            std::lock_guard<std::mutex> lock(mutex);
+            received = s + 1;
+            changed.notify_all();
+        }
+    }));
+
+    std::vector<Acc> localC(static_cast<size_t>(localRows) * localCols, Acc());
+    MatrixView<Acc> c(localC.data(), localRows, localCols, localCols);
+    GemmScratch<P, Acc> scratch;
+    guarded([&]() {
+        for (int s = 0; s < steps; s++) {
+            {
+                const auto begin = std::chrono::steady_clock::now();
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return failed || received > s; });
+                stats.waitUs += elapsedUs(begin);
+                if (failed) {
+                    return;
+                }
+            }
+            const auto begin = std::chrono::steady_clock::now();
+            const int kb = colsA.blockSize(s);
+            gemmBlocked(kernel, params, MatrixView<const T>(panelA[s % 2].data(), localRows, kb, kb),
+                MatrixView<const T>(panelB[s % 2].data(), kb, localCols, localCols), c, scratch);
+            stats.computeUs += elapsedUs(begin);
+            std::lock_guard<std::mutex> lock(mutex);
+            computed = s + 1;
+            changed.notify_all();
+        }
+    })();
+
+    // При ошибке потоки связи могут стоять в ожидании канала: они не дожидаются,
+    // процесс рабочего завершается вместе с ними
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (failed) {
+            sender.detach();
+            receiver.detach();
+            std::rethrow_exception(error);
+        }
+    }
+    sender.join();
+    receiver.join();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    const auto gather = std::chrono::steady_clock::now();
+    coordinator.send(1, localC.data(), localC.size() * sizeof(Acc));
+    stats.bytesSent = bytesSent + static_cast<long long>(localC.size() * sizeof(Acc));
+    stats.bytesReceived += bytesReceived;
+    stats.gatherUs = elapsedUs(gather);
+    stats.totalUs = elapsedUs(start);
+    coordinator.send(1, &stats, sizeof(stats));
+}
+
+} // namespace distributed_detail
+
+// C = A * B на options.workers процессах по схеме SUMMA с блочно-циклическим
+// распределением A, B и C по решётке процессов. Координатор (вызывающий процесс)
+// рассылает рабочим их блоки A и B и собирает блоки C; панели A и B рабочие передают
+// друг другу сами. Рабочие — дочерние процессы fork(): каждый считает в одном потоке
+// вычислений gemmBlocked с микроядром kernel и не пользуется пулами родителя.
+template<class T, class P, class Acc>
+void multiplyDistributed(const MicroKernel<P, Acc>& kernel, const BlockingParams& params,
+    MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+    const DistributedOptions& options, DistributedReport& report) {
+    using namespace distributed_detail;
+    if (options.workers < 1 || options.block < 1) {
+        throw std::invalid_argument("multiplyDistributed: workers and block must be positive");
+    }
+    if (A.cols() != B.rows() || C.rows() != A.rows() || C.cols() != B.cols()) {
+        throw std::invalid_argument("multiplyDistributed: operand shapes do not match");
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const ProcessGrid grid = ProcessGrid::forWorkers(options.workers);
+    const BlockCyclic rowsC = { A.rows(), options.block, grid.rows };
+    const BlockCyclic colsC = { B.cols(), options.block, grid.cols };
+    const BlockCyclic colsA = { A.cols(), options.block, grid.cols };
+    const BlockCyclic rowsB = { B.rows(), options.block, grid.rows };
+    const int workers = options.workers;
+
+    Links links(options.transport, grid);
+    Children children;
+    const pid_t coordinatorPid = getpid();
+    for (int w = 0; w < workers; w++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            throw std::runtime_error(std::string("multiplyDistributed: fork failed: ") + std::strerror(errno));
+        }
+        if (pid == 0) {
+            // Рабочий: завершается вместе с координатором и не возвращается в его код
+            int status = 0;
+            try {
+                prctl(PR_SET_PDEATHSIG, SIGKILL);
+                if (getppid() != coordinatorPid) {
+                    _exit(1);
+                }
+                links.keepWorker(w);
+                runWorker<T>(kernel, params, links, grid, w, rowsC, colsC, colsA, rowsB);
+            } catch (...) {
+                status = 1;
+            }
+            _exit(status);
+        }
+        children.add(pid);
+    }
+    links.keepCoordinator();
+    for (std::unique_ptr<Link>& link : links.coordinator) {
+        link->setAlive([&children]() { return children.healthy(); });
+    }
+
+    std::vector<T> packed;
+    for (int w = 0; w < workers; w++) {
+        const int p = w / grid.cols;
+        const int q = w % grid.cols;
+        packLocal(A, rowsC, p, colsA, q, packed);
+        links.coordinator[w]->send(0, packed.data(), packed.size() * sizeof(T));
+        packLocal(B, rowsB, p, colsC, q, packed);
+        links.coordinator[w]->send(0, packed.data(), packed.size() * sizeof(T));
+    }
+
+    report = DistributedReport();
+    report.transport = options.transport;
+    report.gridRows = grid.rows;
+    report.gridCols = grid.cols;
+    report.block = options.block;
+    report.steps = colsA.blocks();
+    std::vector<Acc> localC;
+    for (int w = 0; w < workers; w++) {
+        const int p = w / grid.cols;
+        const int q = w % grid.cols;
+        localC.resize(static_cast<size_t>(rowsC.localSize(p)) * colsC.localSize(q));
+        links.coordinator[w]->receive(0, localC.data(), localC.size() * sizeof(Acc));
+        unpackLocal(localC, rowsC, p, colsC, q, C);
+        DistributedWorkerStats stats;
+        links.coordinator[w]->receive(0, &stats, sizeof(stats));
+        report.workers.push_back(stats);
+    }
+    if (!children.join()) {
+        throw std::runtime_error("multiplyDistributed: worker process failed");
+    }
+    report.totalUs = elapsedUs(start);
+}
+
+#endif // DISTRIBUTED_H_
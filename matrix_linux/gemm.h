@@ -0,0 +1,340 @@
+#ifndef GEMM_H_
+#define GEMM_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <cstring>
+#include <unistd.h>
+#include "matrix.h"
+#include "partition.h"
+#include "thread_pool.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Размеры кэшей процессора (байты)
+struct CacheInfo {
+    size_t l1;
+    size_t l2;
+    size_t l3;
+
+    static const CacheInfo& detect() {
+        static const CacheInfo info = query();
+        return info;
+    }
+
+private:
+    static size_t cacheSize(int name, size_t fallback) {
+        long value = sysconf(name);
+        return value > 0 ? static_cast<size_t>(value) : fallback;
+    }
+
+    static CacheInfo query() {
+        CacheInfo info;
+        info.l1 = cacheSize(_SC_LEVEL1_DCACHE_SIZE, 32 * 1024);
+        info.l2 = cacheSize(_SC_LEVEL2_CACHE_SIZE, 1024 * 1024);
+        info.l3 = cacheSize(_SC_LEVEL3_CACHE_SIZE, 8 * 1024 * 1024);
+        return info;
+    }
+};
+
+// Микроядро: считает блок MR x NR и прибавляет его к C.
+// a — упакованная полоса A (kc столбцов по MR элементов),
+// b — упакованная полоса B (kc строк по NR элементов).
+// P — тип упакованных элементов, Acc — тип аккумуляторов и C,
+// PB — тип упакованных элементов B, если он отличается от A (u8 x s8).
+// При kGroup > 1 соседние kGroup значений k лежат подряд (для pmaddwd и подобных),
+// а kc кратно kGroup. saturates: пары произведений складываются в int16 с насыщением
+// (pmaddubsw), результат точен, только пока |a0*b0 + a1*b1| <= 32767.
+template<class P, class Acc = P, class PB = P>
+struct MicroKernel {
+    const char* name;
+    int mr;
+    int nr;
+    void (*compute)(int kc, const P* a, const PB* b, Acc* c, int ldc);
+    int kGroup = 1;
+    bool saturates = false;
+};
+
+// Тип аккумулятора по умолчанию: узкие целые расширяются до int32
+template<class T>
+struct DefaultAccumulator {
+    typedef T type;
+};
+
+template<>
+struct DefaultAccumulator<int8_t> {
+    typedef int32_t type;
+};
+
+template<>
+struct DefaultAccumulator<int16_t> {
+    typedef int32_t type;
+};
+
+// Запись результата в готовую матрицу C
+enum class GemmOutput {
+    Overwrite, // C = A * B
+    Accumulate // C += A * B
+};
+
+// Размеры блоков по уровням кэша:
+//   kc — полосы A (MR x kc) и B (kc x NR) вместе занимают половину L1,
+//   mc — упакованный блок A (mc x kc) занимает половину L2,
+//   nc — упакованная панель B (kc x nc) занимает половину L3.
+struct BlockingParams {
+    int mc;
+    int kc;
+    int nc;
+
+    static BlockingParams forKernel(int mr, int nr, size_t elementSize,
+        const CacheInfo& cache = CacheInfo::detect()) {
+        // kc кратно 8, поэтому им кратны и группы по k микроядер (kGroup <= 8)
+        BlockingParams p;
+        p.kc = static_cast<int>(cache.l1 / 2 / ((mr + nr) * elementSize));
+        p.kc = std::max(16, std::min(p.kc, 1024)) / 8 * 8;
+        p.mc = static_cast<int>(cache.l2 / 2 / (p.kc * elementSize));
+        p.mc = std::max(mr, std::min(p.mc, 1024) / mr * mr);
+        p.nc = static_cast<int>(cache.l3 / 2 / (p.kc * elementSize));
+        p.nc = std::max(nr, std::min(p.nc, 4096) / nr * nr);
+        return p;
+    }
+};
+
+// Выровненный буфер для упакованных панелей; растёт по требованию
+template<class T>
+class PackBuffer {
+public:
+    PackBuffer() : data_(nullptr), capacity_(0) {}
+    ~PackBuffer() { std::free(data_); }
+
+    PackBuffer(const PackBuffer&) = delete;
+    PackBuffer& operator=(const PackBuffer&) = delete;
+
+    T* reserve(size_t count) {
+        if (count > capacity_) {
+            std::free(data_);
+            data_ = nullptr;
+            void* ptr = nullptr;
+            if (posix_memalign(&ptr, kMatrixAlignment, count * sizeof(T)) != 0) {
+                capacity_ = 0;
+                throw std::bad_alloc();
+            }
+            alignedAllocations.fetch_add(1, std::memory_order_relaxed);
+            data_ = static_cast<T*>(ptr);
+            capacity_ = count;
+        }
+        return data_;
+    }
+
+private:
+    T* data_;
+    size_t capacity_;
+};
+
+// Перенос src в dst (одного размера) потоковыми записями мимо кэша: линии dst не
+// читаются перед записью и не вытесняют рабочие данные. Выровненные 16-байтные
+// части строк пишутся movntdq, края строк — обычными записями; в конце sfence,
+// чтобы записи были видны потокам, которые дождутся окончания.
+template<class Acc>
+void storeNonTemporal(MatrixView<const Acc> src, MatrixView<Acc> dst) {
+    const size_t bytes = static_cast<size_t>(dst.cols()) * sizeof(Acc);
+    for (int r = 0; r < dst.rows(); r++) {
+        char* d = reinterpret_cast<char*>(dst.row(r));
+        const char* s = reinterpret_cast<const char*>(src.row(r));
+#if defined(__SSE2__)
+        size_t i = std::min(bytes, (16 - reinterpret_cast<uintptr_t>(d) % 16) % 16);
+        std::memcpy(d, s, i);
+        for (; i + 16 <= bytes; i += 16) {
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + i),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)));
+        }
+        std::memcpy(d + i, s + i, bytes - i);
+#else
+        std::memcpy(d, s, bytes);
+#endif
+    }
+#if defined(__SSE2__)
+    _mm_sfence();
+#endif
+}
+
+// Скалярное микроядро: аккумуляторы MR x NR компилятор держит в регистрах
+template<class P, class Acc, int MR, int NR, class PB = P>
+void scalarMicroKernel(int kc, const P* a, const PB* b, Acc* c, int ldc) {
+    Acc acc[MR][NR] = {};
+    for (int k = 0; k < kc; k++) {
+        for (int r = 0; r < MR; r++) {
+            Acc av = static_cast<Acc>(a[r]);
+            for (int j = 0; j < NR; j++) {
+                acc[r][j] += av * static_cast<Acc>(b[j]);
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+    for (int r = 0; r < MR; r++) {
+        Acc* crow = c + static_cast<size_t>(r) * ldc;
+        for (int j = 0; j < NR; j++) {
+            crow[j] += acc[r][j];
+        }
+    }
+}
+
+template<class P, class Acc = P, class PB = P>
+const MicroKernel<P, Acc, PB>& scalarKernel() {
+    static const MicroKernel<P, Acc, PB> kernel = { "scalar", 4, 8, &scalarMicroKernel<P, Acc, 4, 8, PB> };
+    return kernel;
+}
+
+// Упаковка блока A[rows x depth] в полосы по MR строк: для каждой группы из
+// group значений k подряд идут MR строк по group элементов. Хвосты дополняются нулями.
+template<class T, class P>
+void packA(MatrixView<const T> A, int mr, int group, P* out) {
+    for (int i0 = 0; i0 < A.rows(); i0 += mr) {
+        int rows = std::min(mr, A.rows() - i0);
+        for (int k0 = 0; k0 < A.cols(); k0 += group) {
+            int depth = std::min(group, A.cols() - k0);
+            for (int r = 0; r < mr; r++) {
+                for (int g = 0; g < group; g++) {
+                    out[r * group + g] = (r < rows && g < depth)
+                        ? static_cast<P>(A(i0 + r, k0 + g)) : P();
+                }
+            }
+            out += mr * group;
+        }
+    }
+}
+
+// Упаковка панели B[depth x cols] в полосы по NR столбцов: для каждой группы из
+// group значений k подряд идут NR столбцов по group элементов. Хвосты дополняются нулями.
+template<class T, class P>
+void packB(MatrixView<const T> B, int nr, int group, P* out) {
+    for (int j0 = 0; j0 < B.cols(); j0 += nr) {
+        int cols = std::min(nr, B.cols() - j0);
+        for (int k0 = 0; k0 < B.rows(); k0 += group) {
+            int depth = std::min(group, B.rows() - k0);
+            if (group == 1) {
+                const T* brow = B.row(k0) + j0;
+                for (int j = 0; j < cols; j++) {
+                    out[j] = static_cast<P>(brow[j]);
+                }
+                for (int j = cols; j < nr; j++) {
+                    out[j] = P();
+                }
+            } else {
+                for (int j = 0; j < nr; j++) {
+                    for (int g = 0; g < group; g++) {
+                        out[j * group + g] = (j < cols && g < depth)
+                            ? static_cast<P>(B(k0 + g, j0 + j)) : P();
+                    }
+                }
+            }
+            out += nr * group;
+        }
+    }
+}
+
+// Рабочие буферы одного потока для gemmBlocked
+template<class P, class Acc = P, class PB = P>
+struct GemmScratch {
+    PackBuffer<P> packedA;
+    PackBuffer<PB> packedB;
+    PackBuffer<Acc> edge;
+};
+
+// C += A * B с блокированием по i/k/j и упаковкой панелей A и B.
+// Размеры: A — M x K, B — K x N, C — M x N. Элементы A и B при упаковке приводятся
+// к P и PB.
+template<class TA, class TB, class P, class Acc, class PB>
+void gemmBlocked(const MicroKernel<P, Acc, PB>& kernel, const BlockingParams& params,
+    MatrixView<const TA> A, MatrixView<const TB> B, MatrixView<Acc> C, GemmScratch<P, Acc, PB>& scratch) {
+    const int M = C.rows();
+    const int N = C.cols();
+    const int K = A.cols();
+    const int mr = kernel.mr;
+    const int nr = kernel.nr;
+    const int group = kernel.kGroup;
+    const size_t depth = static_cast<size_t>(params.kc + group);
+
+    P* bufA = scratch.packedA.reserve(static_cast<size_t>(params.mc + mr) * depth);
+    PB* bufB = scratch.packedB.reserve(static_cast<size_t>(params.nc + nr) * depth);
+    Acc* edge = scratch.edge.reserve(static_cast<size_t>(mr) * nr);
+
+    for (int jc = 0; jc < N; jc += params.nc) {
+        int nc = std::min(params.nc, N - jc);
+        for (int pc = 0; pc < K; pc += params.kc) {
+            int kc = std::min(params.kc, K - pc);
+            int kcPadded = (kc + group - 1) / group * group;
+            packB(B.tile(pc, jc, kc, nc), nr, group, bufB);
+
+            for (int ic = 0; ic < M; ic += params.mc) {
+                int mc = std::min(params.mc, M - ic);
+                packA(A.tile(ic, pc, mc, kc), mr, group, bufA);
+
+                for (int jr = 0; jr < nc; jr += nr) {
+                    int cols = std::min(nr, nc - jr);
+                    const PB* b = bufB + static_cast<size_t>(jr) * kcPadded;
+                    for (int ir = 0; ir < mc; ir += mr) {
+                        int rows = std::min(mr, mc - ir);
+                        const P* a = bufA + static_cast<size_t>(ir) * kcPadded;
+                        Acc* c = C.row(ic + ir) + jc + jr;
+                        if (rows == mr && cols == nr) {
+                            kernel.compute(kcPadded, a, b, c, C.stride());
+                            continue;
+                        }
+                        // Краевой блок: считаем во временный буфер и переносим нужную часть
+                        std::fill(edge, edge + mr * nr, Acc());
+                        kernel.compute(kcPadded, a, b, edge, nr);
+                        for (int r = 0; r < rows; r++) {
+                            Acc* crow = c + static_cast<size_t>(r) * C.stride();
+                            for (int j = 0; j < cols; j++) {
+                                crow[j] += edge[r * nr + j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// C = A * B на пуле: плитки по строкам и столбцам C (K не режется), каждая
+// обнуляется и считается блочным ядром с буферами упаковки своего потока.
+// K проходится частями по kChunk; после каждой части afterChunk(плитка C) может
+// привести накопленные значения (например, по модулю) до следующей части.
+template<class TA, class TB, class P, class Acc, class PB, class F>
+void gemmParallelChunked(const MicroKernel<P, Acc, PB>& kernel, const BlockingParams& params,
+    MatrixView<const TA> A, MatrixView<const TB> B, MatrixView<Acc> C, ThreadPool& pool, int kChunk, F afterChunk) {
+    const int K = A.cols();
+    kChunk = std::max(1, std::min(kChunk, K));
+    const Partition partition = Partition::forShape(C.rows(), C.cols(), K, pool.size(), false);
+    pool.parallelFor(partition.tiles(), [&](int tile) {
+        thread_local GemmScratch<P, Acc, PB> localScratch;
+        TileRange range = partition.tile(tile);
+        const int rows = range.endRow - range.startRow;
+        const int cols = range.endCol - range.startCol;
+        MatrixView<Acc> c = C.tile(range.startRow, range.startCol, rows, cols);
+        for (int r = 0; r < rows; r++) {
+            std::fill(c.row(r), c.row(r) + cols, Acc());
+        }
+        for (int k0 = 0; k0 < K; k0 += kChunk) {
+            const int depth = std::min(kChunk, K - k0);
+            gemmBlocked(kernel, params, A.tile(range.startRow, k0, rows, depth),
+                B.tile(k0, range.startCol, depth, cols), c, localScratch);
+            afterChunk(c);
+        }
+    });
+}
+
+template<class TA, class TB, class P, class Acc, class PB>
+void gemmParallel(const MicroKernel<P, Acc, PB>& kernel, const BlockingParams& params,
+    MatrixView<const TA> A, MatrixView<const TB> B, MatrixView<Acc> C, ThreadPool& pool) {
+    gemmParallelChunked(kernel, params, A, B, C, pool, A.cols(), [](MatrixView<Acc>) {});
+}
+
+#endif // GEMM_H_
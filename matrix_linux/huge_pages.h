@@ -0,0 +1,164 @@
+#ifndef HUGE_PAGES_H_
+#define HUGE_PAGES_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "detail.h"
+#include "thread_pool.h"
+
+// Страницы под буферы матриц. Крупная матрица на страницах 4 КиБ занимает тысячи
+// записей TLB, и обход B по столбцам промахивается в dTLB почти на каждой строке;
+// большая страница (обычно 2 МиБ) покрывает сотни строк одной записью.
+enum class MatrixPages {
+    Small,       // обычные страницы
+    Transparent, // madvise(MADV_HUGEPAGE): прозрачные большие страницы, если ядро их соберёт
+    Huge         // MAP_HUGETLB из зарезервированного пула (vm.nr_hugepages)
+};
+
+inline const char* matrixPagesName(MatrixPages pages) {
+    switch (pages) {
+    case MatrixPages::Transparent:
+        return "thp";
+    case MatrixPages::Huge:
+        return "huge";
+    default:
+        return "small";
+    }
+}
+
+// Размер большой страницы (Hugepagesize из /proc/meminfo), по умолчанию 2 МиБ
+inline size_t hugePageSize() {
+    static const size_t size = []() {
+        std::ifstream meminfo("/proc/meminfo");
+        std::string line;
+        while (std::getline(meminfo, line)) {
+            if (line.compare(0, 13, "Hugepagesize:") == 0) {
+                size_t kib = std::strtoull(line.c_str() + 13, nullptr, 10);
+                if (kib > 0) {
+                    return kib * 1024;
+                }
+            }
+        }
+        return static_cast<size_t>(2) << 20;
+    }();
+    return size;
+}
+
+// Страницы для матриц, которым они не заданы явно (в том числе для результатов умножений)
+inline std::atomic<MatrixPages> defaultMatrixPages(MatrixPages::Small);
+
+namespace huge_pages_detail {
+
+inline size_t roundUp(size_t bytes, size_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+}
+
+} // namespace huge_pages_detail
+
+// Буфер bytes байт с выравниванием alignment на страницах requested, если получится:
+// Huge — MAP_HUGETLB, при пустом пуле — как Transparent; Transparent — выравнивание по
+// большой странице и madvise(MADV_HUGEPAGE), без поддержки в ядре — обычные страницы.
+// Буферы меньше большой страницы всегда на обычных страницах. obtained получает
+// то, что вышло на самом деле; nullptr — памяти нет.
+inline void* allocatePages(size_t bytes, size_t alignment, MatrixPages requested, MatrixPages& obtained) {
+    const size_t huge = hugePageSize();
+    if (requested != MatrixPages::Small && bytes >= huge) {
+        const size_t rounded = huge_pages_detail::roundUp(bytes, huge);
+        if (requested == MatrixPages::Huge) {
+            void* ptr = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                -1, 0);
+            if (ptr != MAP_FAILED) {
+                obtained = MatrixPages::Huge;
+                return ptr;
+            }
+        }
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, huge, rounded) == 0) {
+            obtained = madvise(ptr, rounded, MADV_HUGEPAGE) == 0 ? MatrixPages::Transparent : MatrixPages::Small;
+            return ptr;
+        }
+    }
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, alignment, bytes) != 0) {
+        return nullptr;
+    }
+    obtained = MatrixPages::Small;
+    return ptr;
+}
+
+inline void releasePages(void* ptr, size_t bytes, MatrixPages obtained) {
+    if (!ptr) {
+        return;
+    }
+    if (obtained == MatrixPages::Huge) {
+        munmap(ptr, huge_pages_detail::roundUp(bytes, hugePageSize()));
+    } else {
+        std::free(ptr);
+    }
+}
+
+// Первое касание каждой страницы буфера на пуле: страницы выделяются ядром здесь,
+// параллельно, а не внутри замеряемого умножения. Содержимое не меняется.
+inline void prefaultPages(void* data, size_t bytes, ThreadPool& pool) {
+    if (!data || bytes == 0) {
+        return;
+    }
+    const size_t page = static_cast<size_t>(std::max(4096L, sysconf(_SC_PAGESIZE)));
+    const size_t pages = (bytes + page - 1) / page;
+    const int chunks = detail::chunkCount(static_cast<long long>(pages), pool);
+    char* base = static_cast<char*>(data);
+    pool.parallelFor(chunks, [&](int chunk) {
+        const size_t begin = detail::chunkBegin(pages, chunks, chunk);
+        const size_t end = detail::chunkBegin(pages, chunks, chunk + 1);
+        for (size_t p = begin; p < end; p++) {
+            volatile char* touch = base + p * page;
+            *touch = *touch;
+        }
+    });
+}
+
+// Сколько байт отображения, содержащего data, лежит в больших страницах
+// (AnonHugePages и Private_Hugetlb из /proc/self/smaps); -1 — smaps недоступен.
+// Соседние выделения могут входить в то же отображение.
+inline long long hugePageBytes(const void* data) {
+    std::ifstream smaps("/proc/self/smaps");
+    if (!smaps) {
+        return -1;
+    }
+    const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+    bool inside = false;
+    long long bytes = 0;
+    std::string line;
+    while (std::getline(smaps, line)) {
+        uintptr_t begin = 0;
+        uintptr_t end = 0;
+        char dash = 0;
+        std::istringstream header(line);
+        if (header >> std::hex >> begin >> dash >> end && dash == '-') {
+            if (inside) {
+                break;
+            }
+            inside = address >= begin && address < end;
+            continue;
+        }
+        if (!inside) {
+            continue;
+        }
+        if (line.compare(0, 14, "AnonHugePages:") == 0) {
+            bytes += std::strtoll(line.c_str() + 14, nullptr, 10) * 1024;
+        } else if (line.compare(0, 16, "Private_Hugetlb:") == 0) {
+            bytes += std::strtoll(line.c_str() + 16, nullptr, 10) * 1024;
+        }
+    }
+    return bytes;
+}
+
+#endif // HUGE_PAGES_H_
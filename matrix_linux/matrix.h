@@ -0,0 +1,256 @@
+#ifndef MATRIX_H_
+#define MATRIX_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "huge_pages.h"
+
+// Выравнивание буфера и шага строки: одна кэш-линия
+const size_t kMatrixAlignment = 64;
+
+// Сколько выровненных буферов (матриц и панелей упаковки) выделено за время работы
+// процесса: по разности до и после видно, выделяют ли повторные умножения память
+inline std::atomic<long long> alignedAllocations(0);
+
+// Невладеющее представление прямоугольной области матрицы (строки подряд, шаг stride)
+template<class T>
+class MatrixView {
+public:
+    MatrixView() : data_(nullptr), rows_(0), cols_(0), stride_(0) {}
+    MatrixView(T* data, int rows, int cols, int stride)
+        : data_(data), rows_(rows), cols_(cols), stride_(stride) {}
+
+    // Изменяемое представление приводится к константному
+    operator MatrixView<const T>() const {
+        return MatrixView<const T>(data_, rows_, cols_, stride_);
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int stride() const { return stride_; }
+    bool empty() const { return rows_ == 0 || cols_ == 0; }
+    T* data() const { return data_; }
+
+    T* row(int i) const { return data_ + static_cast<size_t>(i) * stride_; }
+    T& operator()(int i, int j) const { return data_[static_cast<size_t>(i) * stride_ + j]; }
+
+    // Подматрица rows x cols, начинающаяся в (row, col)
+    MatrixView tile(int row, int col, int rows, int cols) const {
+        return MatrixView(data_ + static_cast<size_t>(row) * stride_ + col, rows, cols, stride_);
+    }
+
+    // Полоса строк [begin, end)
+    MatrixView rowRange(int begin, int end) const {
+        return tile(begin, 0, end - begin, cols_);
+    }
+
+private:
+    T* data_;
+    int rows_;
+    int cols_;
+    int stride_;
+};
+
+// Плотная матрица в одном выровненном буфере (row-major).
+// Шаг строки дополняется до целой кэш-линии, поэтому каждая строка начинается
+// с выровненного адреса. Буфер берётся на страницах defaultMatrixPages, если они
+// не заданы явно (uninitialized с MatrixPages); копия — на страницах оригинала.
+template<class T>
+class Matrix {
+    static_assert(std::is_trivially_copyable<T>::value, "Matrix<T> requires a trivially copyable T");
+
+public:
+    Matrix() : data_(nullptr), rows_(0), cols_(0), stride_(0), pages_(MatrixPages::Small) {}
+
+    // Матрица rows x cols, заполненная нулями
+    Matrix(int rows, int cols) : Matrix(rows, cols, T()) {}
+
+    Matrix(int rows, int cols, T value)
+        : data_(nullptr), rows_(rows), cols_(cols), stride_(paddedStride(cols)), pages_(MatrixPages::Small) {
+        allocate(defaultMatrixPages.load(std::memory_order_relaxed));
+        fill(value);
+    }
+
+    Matrix(const Matrix& other)
+        : data_(nullptr), rows_(other.rows_), cols_(other.cols_), stride_(other.stride_),
+          pages_(MatrixPages::Small) {
+        allocate(other.pages_);
+        if (data_) {
+            std::memcpy(data_, other.data_, bufferBytes());
+        }
+    }
+
+    Matrix(Matrix&& other) noexcept
+        : data_(other.data_), rows_(other.rows_), cols_(other.cols_), stride_(other.stride_),
+          pages_(other.pages_) {
+        other.data_ = nullptr;
+        other.rows_ = other.cols_ = other.stride_ = 0;
+    }
+
+    Matrix& operator=(const Matrix& other) {
+        if (this != &other) {
+            Matrix copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    Matrix& operator=(Matrix&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = other.data_;
+            rows_ = other.rows_;
+            cols_ = other.cols_;
+            stride_ = other.stride_;
+            pages_ = other.pages_;
+            other.data_ = nullptr;
+            other.rows_ = other.cols_ = other.stride_ = 0;
+        }
+        return *this;
+    }
+
+    ~Matrix() { release(); }
+
+    void swap(Matrix& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(rows_, other.rows_);
+        std::swap(cols_, other.cols_);
+        std::swap(stride_, other.stride_);
+        std::swap(pages_, other.pages_);
+    }
+
+    // Матрица без заполнения: страницы буфера получает узел NUMA того потока,
+    // который первым в них запишет
+    static Matrix uninitialized(int rows, int cols) {
+        return uninitialized(rows, cols, defaultMatrixPages.load(std::memory_order_relaxed));
+    }
+
+    static Matrix uninitialized(int rows, int cols, MatrixPages pages) {
+        Matrix result;
+        result.rows_ = rows;
+        result.cols_ = cols;
+        result.stride_ = paddedStride(cols);
+        result.allocate(pages);
+        return result;
+    }
+
+    // Переход от старого представления vector<vector<T>>
+    static Matrix fromNested(const std::vector<std::vector<T>>& nested) {
+        int rows = static_cast<int>(nested.size());
+        int cols = rows > 0 ? static_cast<int>(nested[0].size()) : 0;
+        for (const std::vector<T>& row : nested) {
+            if (row.size() != static_cast<size_t>(cols)) {
+                throw std::invalid_argument("Matrix::fromNested: rows have different lengths");
+            }
+        }
+        Matrix result(rows, cols);
+        for (int i = 0; i < rows; i++) {
+            std::memcpy(result.row(i), nested[i].data(), cols * sizeof(T));
+        }
+        return result;
+    }
+
+    std::vector<std::vector<T>> toNested() const {
+        std::vector<std::vector<T>> nested(rows_, std::vector<T>(cols_));
+        for (int i = 0; i < rows_; i++) {
+            std::memcpy(nested[i].data(), row(i), cols_ * sizeof(T));
+        }
+        return nested;
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int stride() const { return stride_; }
+    bool empty() const { return rows_ == 0 || cols_ == 0; }
+    // Страницы, которые буфер получил на самом деле (Huge может стать Transparent или Small)
+    MatrixPages pages() const { return pages_; }
+
+    // Параллельное первое касание страниц буфера (до замеров); содержимое не меняется
+    void prefault(ThreadPool& pool) { prefaultPages(data_, bufferBytes(), pool); }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    T* row(int i) { return data_ + static_cast<size_t>(i) * stride_; }
+    const T* row(int i) const { return data_ + static_cast<size_t>(i) * stride_; }
+
+    T& operator()(int i, int j) { return data_[static_cast<size_t>(i) * stride_ + j]; }
+    const T& operator()(int i, int j) const { return data_[static_cast<size_t>(i) * stride_ + j]; }
+
+    MatrixView<T> view() { return MatrixView<T>(data_, rows_, cols_, stride_); }
+    MatrixView<const T> view() const { return MatrixView<const T>(data_, rows_, cols_, stride_); }
+
+    MatrixView<T> tile(int row, int col, int rows, int cols) {
+        return view().tile(row, col, rows, cols);
+    }
+    MatrixView<const T> tile(int row, int col, int rows, int cols) const {
+        return view().tile(row, col, rows, cols);
+    }
+
+    void fill(T value) {
+        for (int i = 0; i < rows_; i++) {
+            T* r = row(i);
+            for (int j = 0; j < stride_; j++) {
+                r[j] = value;
+            }
+        }
+    }
+
+    // Число элементов в строке с учётом дополнения до кэш-линии
+    static int paddedStride(int cols) {
+        const int perLine = static_cast<int>(kMatrixAlignment / sizeof(T));
+        if (perLine <= 1) {
+            return cols;
+        }
+        return (cols + perLine - 1) / perLine * perLine;
+    }
+
+private:
+    size_t bufferBytes() const {
+        return static_cast<size_t>(rows_) * stride_ * sizeof(T);
+    }
+
+    void allocate(MatrixPages pages) {
+        size_t bytes = bufferBytes();
+        pages_ = MatrixPages::Small;
+        if (bytes == 0) {
+            return;
+        }
+        void* ptr = allocatePages(bytes, kMatrixAlignment, pages, pages_);
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        alignedAllocations.fetch_add(1, std::memory_order_relaxed);
+        data_ = static_cast<T*>(ptr);
+    }
+
+    void release() {
+        releasePages(data_, bufferBytes(), pages_);
+        data_ = nullptr;
+    }
+
+    T* data_;
+    int rows_;
+    int cols_;
+    int stride_;
+    MatrixPages pages_;
+};
+
+// Имя типа элементов для вывода и профилей
+template<class T> inline const char* elementTypeName();
+template<> inline const char* elementTypeName<int8_t>() { return "int8"; }
+template<> inline const char* elementTypeName<int16_t>() { return "int16"; }
+template<> inline const char* elementTypeName<int32_t>() { return "int32"; }
+template<> inline const char* elementTypeName<int64_t>() { return "int64"; }
+template<> inline const char* elementTypeName<float>() { return "float"; }
+template<> inline const char* elementTypeName<double>() { return "double"; }
+
+#endif // MATRIX_H_
@@ -0,0 +1,768 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "matrix_multiplier.h"
+
+// Счётчик выделений через operator new (контейнеры, задачи, потоки). Буферы матриц
+// и панелей упаковки выделяются через posix_memalign и считаются в alignedAllocations.
+static std::atomic<long long> heapAllocations(0);
+
+// Не встраиваются: иначе GCC видит пару malloc / operator delete (или operator new / free)
+// и предупреждает о несовпадении
+__attribute__((noinline)) void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+// Драйвер замеров умножения матриц.
+// Матрицы каждой формы генерируются один раз из фиксированного seed генератором со
+// счётчиком (одинаково при любом --threads), поэтому строки результата сравнимы между
+// размерами блоков, числом потоков, ядрами и сборками.
+// Каждый вариант прогревается warmup раз и затем замеряется repetitions раз.
+
+namespace {
+
+const char* const kVariants[] = { "seq", "blocked", "blocked-into", "strassen", "std", "pthread", "pinned", "pool",
+    "pool-into", "steal", "dist-shm", "dist-socket", "quantized", "tuned" };
+
+struct Shape {
+    int m;
+    int k;
+    int n;
+};
+
+struct BenchConfig {
+    std::vector<Shape> shapes;
+    std::vector<int> blocks;             // 0 — разбиение под форму задачи
+    std::vector<int> threads;            // 0 — общий пул размером hardware_concurrency()
+    std::vector<std::string> kernels;    // для blocked/strassen; пусто — лучшее ядро, "all" — все
+    std::vector<std::string> variants;
+    std::string type;
+    int warmup;
+    int repetitions;
+    int cutoff;
+    unsigned int seed;
+    std::string format;                  // table, csv, json
+    std::string output;                  // пусто — stdout
+    bool verify;
+    std::string check;                   // reference, exact, freivalds
+    std::string counters;                // off, run, tile — счётчики perf
+    std::vector<MatrixPages> pages;      // страницы операндов и результатов
+    std::vector<std::string> tiles;      // shared, aligned — плитки std/pthread/pool
+};
+
+struct BenchResult {
+    std::string variant;
+    std::string kernel;
+    std::string type;
+    std::string pages;    // запрошенные страницы; "huge->thp" — вышли другие
+    int m;
+    int k;
+    int n;
+    int block;
+    int threads;          // потоков варианта: пул, процессы dist-* или по потоку на плитку у std/pthread
+    int repetitions;
+    double minUs;
+    double medianUs;
+    double p95Us;
+    double gops;          // 2*M*N*K операций за медианное время
+    int correct;          // 1/0, -1 — проверка отключена
+    double tailUs;        // steal: разброс моментов завершения рабочих
+    int steals;           // steal: число краж
+    long long pagesLocal; // pinned: страницы на своём узле NUMA
+    long long pagesRemote;
+    // Счётчики perf на один повтор; -1 — счётчик недоступен
+    double cycles;
+    double instructions;
+    double ipc;
+    double l1dPerFlop;    // промахов L1d на операцию
+    double llcPerFlop;
+    double dtlbPerFlop;
+    double tileIpcMin;    // pool при --counters tile: разброс IPC по плиткам
+    double tileIpcMax;
+    double allocations;   // выделений памяти на один повтор (operator new и выровненные буферы)
+    std::string tiles;    // shared, aligned; "-" — вариант без разбиения Partition
+    double sharedLines;   // доля линий C, в которые пишут несколько плиток; -1 — не применимо
+    std::string grid;     // dist-*: решётка процессов, "-" — не применимо
+    double overlap;       // dist-*: доля приёма панелей, скрытая за счётом; -1 — не применимо
+    double waitUs;        // dist-*: наибольшее ожидание панелей среди рабочих
+};
+
+void printUsage(std::ostream& out) {
+    out << "Usage: matrix_bench [options]\n"
+        << "  --sizes 100,200,500        square sizes\n"
+        << "  --shapes 2000x64x32,...    M x K x N products\n"
+        << "  --blocks 0,16,64           block sizes (0 = shape-aware partition)\n"
+        << "  --threads 0,1,4            pool sizes (0 = hardware_concurrency);\n"
+        << "                             std/pthread/pinned report one thread per tile\n"
+        << "  --kernels all|name,...     micro-kernels for blocked/strassen\n"
+        << "  --variants seq,blocked,blocked-into,strassen,std,pthread,pinned,pool,pool-into,steal,\n"
+        << "             dist-shm,dist-socket,quantized,tuned (dist-*: threads = worker processes;\n"
+        << "             quantized: u8 x s8 -> int32, approximate and unverified for float types)\n"
+        << "  --type int8|int16|int32|int32:int64|int64|float|double\n"
+        << "  --warmup 1 --reps 5 --seed 42 --cutoff 512\n"
+        << "  --format table|csv|json --output FILE\n"
+        << "  --verify reference|exact|freivalds | --no-verify\n"
+        << "  --counters off|run|tile    perf counters per run (tile: also per pool tile)\n"
+        << "  --pages small,thp,huge     pages for matrices (thp: MADV_HUGEPAGE, huge: MAP_HUGETLB)\n"
+        << "  --tiles shared,aligned     std/pthread/pool tiles (aligned: whole cache lines, private buffers)\n";
+}
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+int parseInt(const std::string& text, const std::string& option) {
+    try {
+        size_t used = 0;
+        int value = std::stoi(text, &used);
+        if (used == text.size()) {
+            return value;
+        }
+    } catch (const std::exception&) {
+    }
+    throw std::invalid_argument("matrix_bench: bad value '" + text + "' for " + option);
+}
+
+std::vector<int> parseIntList(const std::string& text, const std::string& option) {
+    std::vector<int> values;
+    for (const std::string& item : splitList(text)) {
+        values.push_back(parseInt(item, option));
+    }
+    return values;
+}
+
+Shape parseShape(const std::string& text) {
+    std::vector<int> dims;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, 'x')) {
+        dims.push_back(parseInt(item, "--shapes"));
+    }
+    if (dims.size() != 3 || dims[0] <= 0 || dims[1] <= 0 || dims[2] <= 0) {
+        throw std::invalid_argument("matrix_bench: shape must be MxKxN, got '" + text + "'");
+    }
+    return Shape{ dims[0], dims[1], dims[2] };
+}
+
+BenchConfig parseArgs(int argc, char** argv) {
+    BenchConfig config;
+    config.type = "int32";
+    config.warmup = 1;
+    config.repetitions = 5;
+    config.cutoff = 512;
+    config.seed = 42;
+    config.format = "table";
+    config.verify = true;
+    config.check = "reference";
+    config.counters = "run";
+
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--help" || option == "-h") {
+            printUsage(std::cout);
+            std::exit(0);
+        }
+        if (option == "--no-verify") {
+            config.verify = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("matrix_bench: unknown option or missing value: " + option);
+        }
+        std::string value = argv[++i];
+        if (option == "--sizes") {
+            for (int size : parseIntList(value, option)) {
+                if (size <= 0) {
+                    throw std::invalid_argument("matrix_bench: size must be positive");
+                }
+                config.shapes.push_back(Shape{ size, size, size });
+            }
+        } else if (option == "--shapes") {
+            for (const std::string& item : splitList(value)) {
+                config.shapes.push_back(parseShape(item));
+            }
+        } else if (option == "--blocks") {
+            config.blocks = parseIntList(value, option);
+        } else if (option == "--threads") {
+            config.threads = parseIntList(value, option);
+        } else if (option == "--kernels") {
+            config.kernels = splitList(value);
+        } else if (option == "--variants") {
+            config.variants = splitList(value);
+            for (const std::string& variant : config.variants) {
+                if (std::find(std::begin(kVariants), std::end(kVariants), variant) == std::end(kVariants)) {
+                    throw std::invalid_argument("matrix_bench: unknown variant '" + variant + "'");
+                }
+            }
+        } else if (option == "--type") {
+            config.type = value;
+        } else if (option == "--warmup") {
+            config.warmup = std::max(0, parseInt(value, option));
+        } else if (option == "--reps") {
+            config.repetitions = std::max(1, parseInt(value, option));
+        } else if (option == "--seed") {
+            config.seed = static_cast<unsigned int>(parseInt(value, option));
+        } else if (option == "--cutoff") {
+            config.cutoff = parseInt(value, option);
+        } else if (option == "--format") {
+            if (value != "table" && value != "csv" && value != "json") {
+                throw std::invalid_argument("matrix_bench: unknown format '" + value + "'");
+            }
+            config.format = value;
+        } else if (option == "--output") {
+            config.output = value;
+        } else if (option == "--verify") {
+            if (value != "reference" && value != "exact" && value != "freivalds") {
+                throw std::invalid_argument("matrix_bench: unknown verification '" + value + "'");
+            }
+            config.check = value;
+        } else if (option == "--counters") {
+            if (value != "off" && value != "run" && value != "tile") {
+                throw std::invalid_argument("matrix_bench: unknown counters mode '" + value + "'");
+            }
+            config.counters = value;
+        } else if (option == "--tiles") {
+            config.tiles = splitList(value);
+            for (const std::string& tiles : config.tiles) {
+                if (tiles != "shared" && tiles != "aligned") {
+                    throw std::invalid_argument("matrix_bench: unknown tiles '" + tiles + "'");
+                }
+            }
+        } else if (option == "--pages") {
+            for (const std::string& item : splitList(value)) {
+                if (item == "small") {
+                    config.pages.push_back(MatrixPages::Small);
+                } else if (item == "thp") {
+                    config.pages.push_back(MatrixPages::Transparent);
+                } else if (item == "huge") {
+                    config.pages.push_back(MatrixPages::Huge);
+                } else {
+                    throw std::invalid_argument("matrix_bench: unknown pages '" + item + "'");
+                }
+            }
+        } else {
+            throw std::invalid_argument("matrix_bench: unknown option " + option);
+        }
+    }
+
+    if (config.shapes.empty()) {
+        for (int size : { 100, 200, 500 }) {
+            config.shapes.push_back(Shape{ size, size, size });
+        }
+    }
+    if (config.blocks.empty()) {
+        config.blocks.push_back(0);
+    }
+    if (config.threads.empty()) {
+        config.threads.push_back(0);
+    }
+    if (config.variants.empty()) {
+        config.variants.assign(std::begin(kVariants), std::end(kVariants));
+    }
+    if (config.tiles.empty()) {
+        config.tiles.push_back("shared");
+    }
+    if (config.pages.empty()) {
+        config.pages.push_back(MatrixPages::Small);
+    }
+    return config;
+}
+
+// Значение с рангом p (0..1) в отсортированной выборке (метод ближайшего ранга)
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    rank = std::max<size_t>(rank, 1);
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+template<class T, class Acc>
+class BenchRunner {
+public:
+    BenchRunner(const BenchConfig& config, std::vector<BenchResult>& results)
+        : config_(config), results_(results) {}
+
+    void run() {
+        if (config_.counters != "off") {
+            counters_.reset(new PerfCounters());
+            if (!counters_->available()) {
+                std::cerr << "matrix_bench: perf counters unavailable (" << counters_->unavailableReason()
+                          << "), counter columns are -1" << std::endl;
+                counters_.reset();
+            }
+        }
+        // Все матрицы замеров (операнды, результаты, частичные суммы) — на выбранных страницах
+        for (MatrixPages pages : config_.pages) {
+            defaultMatrixPages.store(pages);
+            pages_ = pages;
+            for (const Shape& shape : config_.shapes) {
+                runShape(shape);
+            }
+        }
+        defaultMatrixPages.store(MatrixPages::Small);
+    }
+
+private:
+    typedef BasicMatrixMultiplier<T, Acc> Multiplier;
+    typedef typename KernelSet<T, Acc>::Packed Packed;
+    typedef MicroKernel<Packed, Acc> Kernel;
+
+    bool selected(const char* variant) const {
+        return std::find(config_.variants.begin(), config_.variants.end(), variant) != config_.variants.end();
+    }
+
+    std::vector<const Kernel*> selectedKernels() const {
+        std::vector<const Kernel*> kernels;
+        if (config_.kernels.empty()) {
+            kernels.push_back(&bestKernel<T, Acc>());
+            return kernels;
+        }
+        for (const std::string& name : config_.kernels) {
+            if (name == "all") {
+                return availableKernels<T, Acc>();
+            }
+            const Kernel* kernel = findKernel<T, Acc>(name);
+            if (kernel) {
+                kernels.push_back(kernel);
+            } else {
+                std::cerr << "matrix_bench: kernel '" << name << "' is not available for "
+                          << elementTypeName<T>() << ", skipped" << std::endl;
+            }
+        }
+        return kernels;
+    }
+
+    static long long allocationCount() {
+        return heapAllocations.load(std::memory_order_relaxed) + alignedAllocations.load(std::memory_order_relaxed);
+    }
+
+    // multiply(C) записывает произведение в C: возвращающие варианты присваивают
+    // новую матрицу, варианты *-into пишут в матрицу, выделенную и затронутую
+    // (prefault) до замеров
+    template<class F>
+    BenchResult measure(const char* variant, const char* kernel, const Shape& shape, int block,
+        int threads, F&& multiply) {
+        Matrix<Acc> C = Matrix<Acc>::uninitialized(shape.m, shape.n);
+        C.prefault(ThreadPool::shared());
+        for (int i = 0; i < config_.warmup; i++) {
+            multiply(C);
+        }
+        std::vector<double> samples;
+        samples.reserve(config_.repetitions);
+        PerfSample total;
+        long long allocations = 0;
+        for (int i = 0; i < config_.repetitions; i++) {
+            if (counters_) {
+                counters_->start();
+            }
+            const long long allocationsBefore = allocationCount();
+            auto start = std::chrono::steady_clock::now();
+            multiply(C);
+            auto end = std::chrono::steady_clock::now();
+            allocations += allocationCount() - allocationsBefore;
+            if (counters_) {
+                total += counters_->stop();
+            }
+            samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+        std::sort(samples.begin(), samples.end());
+
+        BenchResult result = {};
+        result.variant = variant;
+        result.kernel = kernel;
+        result.type = std::string(elementTypeName<T>()) + "->" + elementTypeName<Acc>();
+        result.pages = matrixPagesName(pages_);
+        if (a_->pages() != pages_) {
+            result.pages += std::string("->") + matrixPagesName(a_->pages());
+        }
+        result.m = shape.m;
+        result.k = shape.k;
+        result.n = shape.n;
+        result.block = block;
+        result.threads = threads;
+        result.repetitions = config_.repetitions;
+        result.minUs = samples.front();
+        result.medianUs = percentile(samples, 0.5);
+        result.p95Us = percentile(samples, 0.95);
+        double ops = 2.0 * shape.m * shape.n * shape.k;
+        result.gops = result.medianUs > 0.0 ? ops / (result.medianUs * 1e3) : 0.0;
+        const double reps = config_.repetitions;
+        result.cycles = total.has(kPerfCycles) ? total.value[kPerfCycles] / reps : -1.0;
+        result.instructions = total.has(kPerfInstructions) ? total.value[kPerfInstructions] / reps : -1.0;
+        result.ipc = total.ipc();
+        result.l1dPerFlop = total.perFlop(kPerfL1dMisses, ops * reps);
+        result.llcPerFlop = total.perFlop(kPerfLlcMisses, ops * reps);
+        result.dtlbPerFlop = total.perFlop(kPerfDtlbMisses, ops * reps);
+        result.tileIpcMin = -1.0;
+        result.tileIpcMax = -1.0;
+        result.allocations = static_cast<double>(allocations) / reps;
+        result.tiles = "-";
+        result.sharedLines = -1.0;
+        result.grid = "-";
+        result.overlap = -1.0;
+        result.waitUs = -1.0;
+        result.correct = config_.verify ? (verifyResult(C) ? 1 : 0) : -1;
+        return result;
+    }
+
+    // Эталон считается один раз на форму; Фрейвалдсу он не нужен
+    bool verifyResult(const Matrix<Acc>& C) {
+        if (config_.check == "freivalds") {
+            return multiplier_->verifyFreivalds(*a_, *b_, C);
+        }
+        if (config_.check == "exact") {
+            return multiplier_->matchesReferenceParallel(reference_, C);
+        }
+        return multiplier_->matchesReference(reference_, C);
+    }
+
+    void runShape(const Shape& shape) {
+        Multiplier multiplier(shape.m, shape.k, shape.n);
+        multiplier_ = &multiplier;
+        Matrix<T> A(shape.m, shape.k);
+        Matrix<T> B(shape.k, shape.n);
+        multiplier.fillMatrixRandom(A, config_.seed);
+        multiplier.fillMatrixRandom(B, config_.seed + 1);
+        a_ = &A;
+        b_ = &B;
+        if (config_.verify && config_.check != "freivalds") {
+            reference_ = multiplier.multiplySequential(A, B);
+        }
+
+        bool sequentialDone = false;
+        for (int threadSetting : config_.threads) {
+            multiplier.setThreadCount(threadSetting);
+            const int threads = multiplier.threadCount();
+
+            if (selected("seq") && !sequentialDone) {
+                results_.push_back(measure("seq", "-", shape, -1, 1,
+                    [&](Matrix<Acc>& C) { C = multiplier.multiplySequential(A, B); }));
+                sequentialDone = true;
+            }
+            for (const Kernel* kernel : selectedKernels()) {
+                multiplier.setKernel(*kernel);
+                if (selected("blocked")) {
+                    results_.push_back(measure("blocked", kernel->name, shape, -1, 1,
+                        [&](Matrix<Acc>& C) { C = multiplier.multiplyBlocked(A, B); }));
+                }
+                if (selected("blocked-into")) {
+                    results_.push_back(measure("blocked-into", kernel->name, shape, -1, 1,
+                        [&](Matrix<Acc>& C) { multiplier.multiplyBlocked(A, B, C); }));
+                }
+                if (selected("strassen")) {
+                    // При T != Acc Штрассен работает на расширенных операндах своим ядром
+                    const char* name = std::is_same<T, Acc>::value ? kernel->name : bestKernel<Acc, Acc>().name;
+                    results_.push_back(measure("strassen", name, shape, -1, threads,
+                        [&](Matrix<Acc>& C) { C = multiplier.multiplyStrassen(A, B, config_.cutoff); }));
+                }
+            }
+
+            if (selected("quantized")) {
+                BenchResult result = measure("quantized", "-", shape, -1, threads,
+                    [&](Matrix<Acc>& C) { C = multiplier.multiplyQuantized(A, B); });
+                result.kernel = multiplier.quantizedKernelName();
+                // Вещественные квантуются с потерями и с эталоном совпадать не обязаны
+                if (!std::is_integral<T>::value) {
+                    result.correct = -1;
+                }
+                results_.push_back(result);
+            }
+
+            for (int block : config_.blocks) {
+                // Варианты с разбиением Partition: общие плитки и плитки по кэш-линиям
+                for (const std::string& tiles : config_.tiles) {
+                    multiplier.setLineAlignedTiles(tiles == "aligned");
+                    const size_t first = results_.size();
+                    const Partition partition = multiplier.partition(block);
+                    // std::thread и pthread создают по потоку на плитку, а не берут потоки пула
+                    const int spawned = partition.tiles();
+                    if (selected("std")) {
+                        results_.push_back(measure("std", "-", shape, block, spawned,
+                            [&](Matrix<Acc>& C) { C = multiplier.multiplyParallelStdThread(A, B, block); }));
+                    }
+                    if (selected("pthread")) {
+                        multiplier.setPinThreads(false);
+                        results_.push_back(measure("pthread", "-", shape, block, spawned,
+                            [&](Matrix<Acc>& C) { C = multiplier.multiplyParallelPthread(A, B, block); }));
+                    }
+                    if (selected("pinned")) {
+                        multiplier.setPinThreads(true);
+                        BenchResult result = measure("pinned", "-", shape, block, spawned,
+                            [&](Matrix<Acc>& C) { C = multiplier.multiplyParallelPthread(A, B, block); });
+                        multiplier.setPinThreads(false);
+                        result.pagesLocal = multiplier.numaPlacement().local;
+                        result.pagesRemote = multiplier.numaPlacement().remote;
+                        results_.push_back(result);
+                    }
+                    if (selected("pool")) {
+                        const bool perTile = counters_ && config_.counters == "tile";
+                        multiplier.setTileCounters(perTile);
+                        BenchResult result = measure("pool", "-", shape, block, threads,
+                            [&](Matrix<Acc>& C) { C = multiplier.multiplyParallelPool(A, B, block); });
+                        multiplier.setTileCounters(false);
+                        if (perTile) {
+                            tileIpcRange(multiplier.tileCounters(), result);
+                        }
+                        results_.push_back(result);
+                    }
+                    if (selected("pool-into")) {
+                        results_.push_back(measure("pool-into", "-", shape, block, threads,
+                            [&](Matrix<Acc>& C) { multiplier.multiplyParallelPool(A, B, C, block); }));
+                    }
+                    const double shared = static_cast<double>(partition.sharedLines(Multiplier::lineElements()))
+                        / std::max(1LL, partition.outputLines(Multiplier::lineElements()));
+                    for (size_t r = first; r < results_.size(); r++) {
+                        results_[r].tiles = tiles;
+                        results_[r].sharedLines = shared;
+                    }
+                }
+                multiplier.setLineAlignedTiles(false);
+                if (selected("steal")) {
+                    BenchResult result = measure("steal", "-", shape, block, threads,
+                        [&](Matrix<Acc>& C) { C = multiplier.multiplyParallelWorkStealing(A, B, block); });
+                    result.tailUs = multiplier.stealingStats().tailUs();
+                    result.steals = multiplier.stealingStats().steals();
+                    results_.push_back(result);
+                }
+                // Процессы вместо потоков: рабочих столько же, сколько потоков пула
+                for (DistributedTransport transport : { DistributedTransport::SharedMemory,
+                         DistributedTransport::UnixSocket }) {
+                    const std::string variant = std::string("dist-") + distributedTransportName(transport);
+                    if (!selected(variant.c_str())) {
+                        continue;
+                    }
+                    DistributedOptions options;
+                    options.workers = threads;
+                    options.block = block > 0 ? block : options.block;
+                    options.transport = transport;
+                    BenchResult result = measure(variant.c_str(), "-", shape, options.block, threads,
+                        [&](Matrix<Acc>& C) { C = multiplier.multiplyDistributed(A, B, options); });
+                    const DistributedReport& report = multiplier.distributedReport();
+                    result.grid = std::to_string(report.gridRows) + "x" + std::to_string(report.gridCols);
+                    result.overlap = report.overlap();
+                    result.waitUs = 0.0;
+                    for (const DistributedWorkerStats& worker : report.workers) {
+                        result.waitUs = std::max(result.waitUs, worker.waitUs);
+                    }
+                    results_.push_back(result);
+                }
+            }
+        }
+
+        // Конфигурация из профиля автонастройки (перебор при первом запуске на этой машине)
+        if (selected("tuned")) {
+            const TunedConfig& tuned = multiplier.autoTune();
+            std::string name = tuned.variant + "/" + tuned.kernel;
+            results_.push_back(measure("tuned", name.c_str(), shape, tuned.block, tuned.threads,
+                [&](Matrix<Acc>& C) { C = multiplier.multiply(A, B); }));
+        }
+        multiplier_ = nullptr;
+        a_ = nullptr;
+        b_ = nullptr;
+    }
+
+    // Наименьший и наибольший IPC среди плиток последнего повтора
+    static void tileIpcRange(const std::vector<PerfSample>& tiles, BenchResult& result) {
+        for (const PerfSample& tile : tiles) {
+            double ipc = tile.ipc();
+            if (ipc < 0.0) {
+                continue;
+            }
+            result.tileIpcMin = result.tileIpcMin < 0.0 ? ipc : std::min(result.tileIpcMin, ipc);
+            result.tileIpcMax = std::max(result.tileIpcMax, ipc);
+        }
+    }
+
+    const BenchConfig& config_;
+    std::vector<BenchResult>& results_;
+    std::unique_ptr<PerfCounters> counters_; // нет, если --counters off или счётчики недоступны
+    Multiplier* multiplier_ = nullptr;
+    const Matrix<T>* a_ = nullptr;
+    const Matrix<T>* b_ = nullptr;
+    Matrix<Acc> reference_;
+    MatrixPages pages_ = MatrixPages::Small;
+};
+
+void runBenchmarks(const BenchConfig& config, std::vector<BenchResult>& results) {
+    const std::string& type = config.type;
+    if (type == "int8") {
+        BenchRunner<int8_t, int32_t>(config, results).run();
+    } else if (type == "int16") {
+        BenchRunner<int16_t, int32_t>(config, results).run();
+    } else if (type == "int32") {
+        BenchRunner<int32_t, int32_t>(config, results).run();
+    } else if (type == "int32:int64") {
+        BenchRunner<int32_t, int64_t>(config, results).run();
+    } else if (type == "int64") {
+        BenchRunner<int64_t, int64_t>(config, results).run();
+    } else if (type == "float") {
+        BenchRunner<float, float>(config, results).run();
+    } else if (type == "double") {
+        BenchRunner<double, double>(config, results).run();
+    } else {
+        throw std::invalid_argument("matrix_bench: unknown type '" + type + "'");
+    }
+}
+
+const char* correctText(int correct) {
+    return correct < 0 ? "-" : (correct ? "yes" : "NO");
+}
+
+void writeTable(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << std::left << std::setw(13) << "variant" << std::setw(16) << "kernel" << std::setw(14) << "type"
+        << std::setw(11) << "pages"
+        << std::right << std::setw(18) << "M x K x N" << std::setw(7) << "block" << std::setw(8) << "threads"
+        << std::setw(12) << "min_us" << std::setw(12) << "median_us" << std::setw(12) << "p95_us"
+        << std::setw(9) << "GOPS" << std::setw(8) << "ok" << std::setw(8) << "allocs" << "  extra" << "\n";
+    for (const BenchResult& r : results) {
+        std::ostringstream dims;
+        dims << r.m << "x" << r.k << "x" << r.n;
+        out << std::left << std::setw(13) << r.variant << std::setw(16) << r.kernel << std::setw(14) << r.type
+            << std::setw(11) << r.pages
+            << std::right << std::setw(18) << dims.str() << std::setw(7) << r.block << std::setw(8) << r.threads
+            << std::fixed << std::setprecision(1)
+            << std::setw(12) << r.minUs << std::setw(12) << r.medianUs << std::setw(12) << r.p95Us
+            << std::setprecision(2) << std::setw(9) << r.gops << std::setw(8) << correctText(r.correct)
+            << std::setprecision(1) << std::setw(8) << r.allocations;
+        if (r.variant == "steal") {
+            out << std::setprecision(1) << "  tail " << r.tailUs << " us, steals " << r.steals;
+        } else if (r.variant == "pinned") {
+            out << "  pages local " << r.pagesLocal << ", remote " << r.pagesRemote;
+        }
+        if (r.ipc >= 0.0) {
+            out << std::setprecision(2) << "  ipc " << r.ipc;
+        }
+        if (r.l1dPerFlop >= 0.0 || r.llcPerFlop >= 0.0 || r.dtlbPerFlop >= 0.0) {
+            out << std::scientific << std::setprecision(1) << "  miss/op l1d " << r.l1dPerFlop
+                << " llc " << r.llcPerFlop << " dtlb " << r.dtlbPerFlop << std::fixed;
+        }
+        if (r.tileIpcMin >= 0.0) {
+            out << std::setprecision(2) << "  tile ipc " << r.tileIpcMin << ".." << r.tileIpcMax;
+        }
+        if (r.sharedLines >= 0.0) {
+            out << std::setprecision(1) << "  tiles " << r.tiles << ", shared lines " << r.sharedLines * 100.0 << "%";
+        }
+        if (r.overlap >= 0.0) {
+            out << std::setprecision(1) << "  grid " << r.grid << ", overlap " << r.overlap * 100.0
+                << "%, max wait " << r.waitUs << " us";
+        }
+        out << "\n";
+    }
+}
+
+void writeCsv(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "variant,kernel,type,pages,m,k,n,block,threads,reps,min_us,median_us,p95_us,gops,correct,"
+        << "tail_us,steals,pages_local,pages_remote,cycles,instructions,ipc,l1d_per_flop,llc_per_flop,"
+        << "dtlb_per_flop,tile_ipc_min,tile_ipc_max,allocs_per_rep,tiles,shared_line_fraction,"
+        << "grid,overlap,max_wait_us\n";
+    out << std::fixed;
+    for (const BenchResult& r : results) {
+        out << r.variant << "," << r.kernel << "," << r.type << "," << r.pages << ","
+            << r.m << "," << r.k << "," << r.n << ","
+            << r.block << "," << r.threads << "," << r.repetitions << ","
+            << std::setprecision(3) << r.minUs << "," << r.medianUs << "," << r.p95Us << ","
+            << std::setprecision(4) << r.gops << "," << r.correct << ","
+            << std::setprecision(3) << r.tailUs << "," << r.steals << ","
+            << r.pagesLocal << "," << r.pagesRemote << ","
+            << std::setprecision(0) << r.cycles << "," << r.instructions << ","
+            << std::setprecision(3) << r.ipc << "," << std::scientific << std::setprecision(4)
+            << r.l1dPerFlop << "," << r.llcPerFlop << "," << r.dtlbPerFlop << std::fixed << ","
+            << std::setprecision(3) << r.tileIpcMin << "," << r.tileIpcMax << ","
+            << std::setprecision(1) << r.allocations << "," << r.tiles << ","
+            << std::setprecision(4) << r.sharedLines << "," << r.grid << "," << r.overlap << ","
+            << std::setprecision(3) << r.waitUs << "\n";
+    }
+}
+
+void writeJson(std::ostream& out, const BenchConfig& config, const std::vector<BenchResult>& results) {
+    out << std::fixed;
+    out << "{\n  \"config\": {\"type\": \"" << config.type << "\", \"seed\": " << config.seed
+        << ", \"warmup\": " << config.warmup << ", \"repetitions\": " << config.repetitions
+        << ", \"hardware_threads\": " << std::thread::hardware_concurrency() << "},\n";
+    out << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        out << (i ? ",\n    " : "\n    ")
+            << "{\"variant\": \"" << r.variant << "\", \"kernel\": \"" << r.kernel << "\", \"type\": \"" << r.type
+            << "\", \"pages\": \"" << r.pages << "\", \"m\": " << r.m << ", \"k\": " << r.k << ", \"n\": " << r.n
+            << ", \"block\": " << r.block << ", \"threads\": " << r.threads
+            << std::setprecision(3) << ", \"min_us\": " << r.minUs << ", \"median_us\": " << r.medianUs
+            << ", \"p95_us\": " << r.p95Us << std::setprecision(4) << ", \"gops\": " << r.gops
+            << ", \"correct\": " << r.correct << std::setprecision(3) << ", \"tail_us\": " << r.tailUs
+            << ", \"steals\": " << r.steals << ", \"pages_local\": " << r.pagesLocal
+            << ", \"pages_remote\": " << r.pagesRemote
+            << std::setprecision(0) << ", \"cycles\": " << r.cycles << ", \"instructions\": " << r.instructions
+            << std::setprecision(3) << ", \"ipc\": " << r.ipc << std::scientific << std::setprecision(4)
+            << ", \"l1d_per_flop\": " << r.l1dPerFlop << ", \"llc_per_flop\": " << r.llcPerFlop
+            << ", \"dtlb_per_flop\": " << r.dtlbPerFlop << std::fixed << std::setprecision(3)
+            << ", \"tile_ipc_min\": " << r.tileIpcMin << ", \"tile_ipc_max\": " << r.tileIpcMax
+            << std::setprecision(1) << ", \"allocs_per_rep\": " << r.allocations
+            << ", \"tiles\": \"" << r.tiles << "\"" << std::setprecision(4)
+            << ", \"shared_line_fraction\": " << r.sharedLines << ", \"grid\": \"" << r.grid << "\""
+            << ", \"overlap\": " << r.overlap << std::setprecision(3) << ", \"max_wait_us\": " << r.waitUs << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        BenchConfig config = parseArgs(argc, argv);
+        std::vector<BenchResult> results;
+        runBenchmarks(config, results);
+
+        std::ofstream file;
+        if (!config.output.empty()) {
+            file.open(config.output);
+            if (!file) {
+                throw std::runtime_error("matrix_bench: cannot open " + config.output);
+            }
+        }
+        std::ostream& out = config.output.empty() ? std::cout : file;
+        if (config.format == "csv") {
+            writeCsv(out, results);
+        } else if (config.format == "json") {
+            writeJson(out, config, results);
+        } else {
+            writeTable(out, results);
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        printUsage(std::cerr);
+        return 1;
+    }
+    return 0;
+}
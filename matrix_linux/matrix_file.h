@@ -0,0 +1,279 @@
+#ifndef MATRIX_FILE_H_
+#define MATRIX_FILE_H_
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "matrix.h"
+
+// Двоичный формат матрицы:
+//   заголовок MatrixFileHeader (64 байта),
+//   с dataOffset — плитки tileRows x tileCols по строкам сетки плиток.
+// Каждая плитка хранится целиком (краевые дополнены нулями) и начинается с границы
+// alignment, поэтому плитку можно отобразить, подсказать ядру и освободить отдельно.
+struct MatrixFileHeader {
+    char magic[8];        // "MTXTILE1"
+    uint32_t version;
+    uint32_t dtype;       // matrixFileType<T>()
+    uint32_t elementSize;
+    uint32_t alignment;   // выравнивание начала данных и каждой плитки
+    uint64_t rows;
+    uint64_t cols;
+    uint32_t tileRows;
+    uint32_t tileCols;
+    uint64_t dataOffset;
+    uint64_t tileBytes;   // шаг между плитками в файле
+};
+
+static_assert(sizeof(MatrixFileHeader) == 64, "MatrixFileHeader must stay 64 bytes");
+
+const char kMatrixFileMagic[8] = { 'M', 'T', 'X', 'T', 'I', 'L', 'E', '1' };
+const uint32_t kMatrixFileVersion = 1;
+
+// Код типа элементов в заголовке
+template<class T> inline uint32_t matrixFileType();
+template<> inline uint32_t matrixFileType<int8_t>() { return 1; }
+template<> inline uint32_t matrixFileType<int16_t>() { return 2; }
+template<> inline uint32_t matrixFileType<int32_t>() { return 3; }
+template<> inline uint32_t matrixFileType<int64_t>() { return 4; }
+template<> inline uint32_t matrixFileType<float>() { return 5; }
+template<> inline uint32_t matrixFileType<double>() { return 6; }
+
+// Матрица в файле, отображённая в память целиком (MAP_SHARED).
+// Страницы подгружаются по обращению и вытесняются ядром без swap, так как
+// это страницы файла; madvise по плиткам держит рабочее множество ограниченным.
+template<class T>
+class MappedMatrix {
+public:
+    // Новый файл rows x cols с плитками tileRows x tileCols (заполнен нулями)
+    static MappedMatrix create(const std::string& path, int rows, int cols, int tileRows = 256, int tileCols = 256) {
+        if (rows <= 0 || cols <= 0 || tileRows <= 0 || tileCols <= 0) {
+            throw std::invalid_argument("MappedMatrix: dimensions and tile sizes must be positive");
+        }
+        MatrixFileHeader header = {};
+        std::memcpy(header.magic, kMatrixFileMagic, sizeof(header.magic));
+        header.version = kMatrixFileVersion;
+        header.dtype = matrixFileType<T>();
+        header.elementSize = sizeof(T);
+        header.alignment = static_cast<uint32_t>(std::max<long>(sysconf(_SC_PAGESIZE), 4096));
+        header.rows = rows;
+        header.cols = cols;
+        header.tileRows = tileRows;
+        header.tileCols = tileCols;
+        header.dataOffset = header.alignment;
+        uint64_t tileBytes = static_cast<uint64_t>(tileRows) * tileCols * sizeof(T);
+        header.tileBytes = (tileBytes + header.alignment - 1) / header.alignment * header.alignment;
+
+        MappedMatrix matrix;
+        matrix.header_ = header;
+        matrix.writable_ = true;
+        matrix.fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (matrix.fd_ < 0) {
+            fail("cannot create " + path);
+        }
+        if (ftruncate(matrix.fd_, static_cast<off_t>(matrix.fileBytes())) != 0) {
+            fail("cannot resize " + path);
+        }
+        matrix.map();
+        std::memcpy(matrix.base_, &header, sizeof(header));
+        return matrix;
+    }
+
+    // Существующий файл; тип элементов должен совпадать с T
+    static MappedMatrix open(const std::string& path, bool writable = false) {
+        MappedMatrix matrix;
+        matrix.writable_ = writable;
+        matrix.fd_ = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (matrix.fd_ < 0) {
+            fail("cannot open " + path);
+        }
+        MatrixFileHeader header;
+        if (pread(matrix.fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+            || std::memcmp(header.magic, kMatrixFileMagic, sizeof(header.magic)) != 0
+            || header.version != kMatrixFileVersion) {
+            throw std::invalid_argument("MappedMatrix: " + path + " is not a matrix file");
+        }
+        if (header.dtype != matrixFileType<T>() || header.elementSize != sizeof(T)) {
+            throw std::invalid_argument("MappedMatrix: " + path + " holds another element type");
+        }
+        if (!validLayout(header)) {
+            throw std::invalid_argument("MappedMatrix: " + path + " has a corrupt header");
+        }
+        matrix.header_ = header;
+        struct stat st;
+        if (fstat(matrix.fd_, &st) != 0 || static_cast<uint64_t>(st.st_size) < matrix.fileBytes()) {
+            throw std::invalid_argument("MappedMatrix: " + path + " is truncated");
+        }
+        matrix.map();
+        return matrix;
+    }
+
+    MappedMatrix(MappedMatrix&& other) noexcept
+        : header_(other.header_), fd_(other.fd_), base_(other.base_), writable_(other.writable_) {
+        other.fd_ = -1;
+        other.base_ = nullptr;
+    }
+
+    MappedMatrix& operator=(MappedMatrix&& other) noexcept {
+        if (this != &other) {
+            release();
+            header_ = other.header_;
+            fd_ = other.fd_;
+            base_ = other.base_;
+            writable_ = other.writable_;
+            other.fd_ = -1;
+            other.base_ = nullptr;
+        }
+        return *this;
+    }
+
+    MappedMatrix(const MappedMatrix&) = delete;
+    MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+    ~MappedMatrix() { release(); }
+
+    int rows() const { return static_cast<int>(header_.rows); }
+    int cols() const { return static_cast<int>(header_.cols); }
+    int tileRows() const { return static_cast<int>(header_.tileRows); }
+    int tileCols() const { return static_cast<int>(header_.tileCols); }
+    int gridRows() const { return (rows() + tileRows() - 1) / tileRows(); }
+    int gridCols() const { return (cols() + tileCols() - 1) / tileCols(); }
+
+    // Плитка (tr, tc) без дополнения: строки идут с шагом tileCols()
+    MatrixView<T> tile(int tr, int tc) const {
+        int r = std::min(tileRows(), rows() - tr * tileRows());
+        int c = std::min(tileCols(), cols() - tc * tileCols());
+        return MatrixView<T>(reinterpret_cast<T*>(tileAddress(tr, tc)), r, c, tileCols());
+    }
+
+    // Подсказка, что плитка скоро понадобится: ядро начинает чтение заранее
+    void prefetchTile(int tr, int tc) const { advise(tr, tc, MADV_WILLNEED); }
+
+    // Плитка больше не нужна: страницы снимаются с отображения процесса.
+    // Изменённые страницы остаются в кэше файла и будут записаны на диск.
+    void releaseTile(int tr, int tc) const {
+        if (writable_) {
+            msync(tileAddress(tr, tc), header_.tileBytes, MS_ASYNC);
+        }
+        advise(tr, tc, MADV_DONTNEED);
+    }
+
+    // Сброс всех изменений на диск
+    void flush() const {
+        if (base_ && writable_ && msync(base_, fileBytes(), MS_SYNC) != 0) {
+            fail("msync failed");
+        }
+    }
+
+private:
+    MappedMatrix() : header_(), fd_(-1), base_(nullptr), writable_(false) {}
+
+    [[noreturn]] static void fail(const std::string& what) {
+        throw std::runtime_error("MappedMatrix: " + what + ": " + std::strerror(errno));
+    }
+
+    // Размеры и размещение плиток — те, что мог вывести create(): иначе tile() и
+    // madvise вышли бы за отображение или потеряли выравнивание
+    static bool validLayout(const MatrixFileHeader& h) {
+        const uint64_t maxInt = static_cast<uint64_t>(std::numeric_limits<int>::max());
+        if (h.rows == 0 || h.rows > maxInt || h.cols == 0 || h.cols > maxInt
+            || h.tileRows == 0 || h.tileRows > maxInt || h.tileCols == 0 || h.tileCols > maxInt) {
+            return false;
+        }
+        if (h.alignment < 4096 || (h.alignment & (h.alignment - 1)) != 0
+            || h.dataOffset < sizeof(MatrixFileHeader) || h.dataOffset % h.alignment != 0
+            || h.tileBytes % h.alignment != 0) {
+            return false;
+        }
+        // Плитка целиком помещается в свой шаг; произведения меньше 2^62 и не переполняются
+        if (static_cast<uint64_t>(h.tileRows) * h.tileCols > h.tileBytes / sizeof(T)) {
+            return false;
+        }
+        const uint64_t tiles = ((h.rows + h.tileRows - 1) / h.tileRows) * ((h.cols + h.tileCols - 1) / h.tileCols);
+        return tiles <= (std::numeric_limits<uint64_t>::max() - h.dataOffset) / h.tileBytes;
+    }
+
+    uint64_t fileBytes() const {
+        return header_.dataOffset + static_cast<uint64_t>(gridRows()) * gridCols() * header_.tileBytes;
+    }
+
+    char* tileAddress(int tr, int tc) const {
+        uint64_t index = static_cast<uint64_t>(tr) * gridCols() + tc;
+        return base_ + header_.dataOffset + index * header_.tileBytes;
+    }
+
+    void advise(int tr, int tc, int advice) const {
+        madvise(tileAddress(tr, tc), header_.tileBytes, advice);
+    }
+
+    void map() {
+        int protection = writable_ ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* ptr = mmap(nullptr, fileBytes(), protection, MAP_SHARED, fd_, 0);
+        if (ptr == MAP_FAILED) {
+            fail("mmap failed");
+        }
+        base_ = static_cast<char*>(ptr);
+        // Плитки читаются не по порядку файла: обычное упреждающее чтение только мешает
+        madvise(base_, fileBytes(), MADV_RANDOM);
+    }
+
+    void release() {
+        if (base_) {
+            munmap(base_, fileBytes());
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    MatrixFileHeader header_;
+    int fd_;
+    char* base_;
+    bool writable_;
+};
+
+// Сохранение матрицы из памяти в файл
+template<class T>
+void saveMatrix(const std::string& path, const Matrix<T>& matrix, int tileRows = 256, int tileCols = 256) {
+    MappedMatrix<T> file = MappedMatrix<T>::create(path, matrix.rows(), matrix.cols(), tileRows, tileCols);
+    for (int tr = 0; tr < file.gridRows(); tr++) {
+        for (int tc = 0; tc < file.gridCols(); tc++) {
+            MatrixView<T> tile = file.tile(tr, tc);
+            for (int i = 0; i < tile.rows(); i++) {
+                std::memcpy(tile.row(i), matrix.row(tr * tileRows + i) + tc * tileCols, tile.cols() * sizeof(T));
+            }
+            file.releaseTile(tr, tc);
+        }
+    }
+    file.flush();
+}
+
+// Загрузка матрицы из файла в память
+template<class T>
+Matrix<T> loadMatrix(const std::string& path) {
+    MappedMatrix<T> file = MappedMatrix<T>::open(path);
+    Matrix<T> matrix(file.rows(), file.cols());
+    for (int tr = 0; tr < file.gridRows(); tr++) {
+        for (int tc = 0; tc < file.gridCols(); tc++) {
+            MatrixView<T> tile = file.tile(tr, tc);
+            for (int i = 0; i < tile.rows(); i++) {
+                std::memcpy(matrix.row(tr * file.tileRows() + i) + tc * file.tileCols(), tile.row(i),
+                    tile.cols() * sizeof(T));
+            }
+            file.releaseTile(tr, tc);
+        }
+    }
+    return matrix;
+}
+
+#endif // MATRIX_FILE_H_
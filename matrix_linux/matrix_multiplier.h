@@ -0,0 +1,1534 @@
+#ifndef MATRIX_MULTIPLIER_H_
+#define MATRIX_MULTIPLIER_H_
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <pthread.h>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <limits>
+#include <type_traits>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include "async.h"
+#include "autotune.h"
+#include "batch.h"
+#include "chain.h"
+#include "distributed.h"
+#include "gemm.h"
+#include "matrix.h"
+#include "matrix_file.h"
+#include "numa.h"
+#include "partition.h"
+#include "perf_counters.h"
+#include "power.h"
+#include "quantized.h"
+#include "random_fill.h"
+#include "simd_kernels.h"
+#include "sparse.h"
+#include "strassen.h"
+#include "thread_pool.h"
+#include "verify.h"
+#include "work_stealing.h"
+
+// Причина недоступности счётчиков perf печатается один раз на программу,
+// а не для каждого типа элементов
+inline bool perfUnavailableReported = false;
+
+// Умножение матриц с элементами T и аккумуляторами Acc (C имеет тип Acc).
+// Для int8/int16 по умолчанию Acc = int32; int32 можно накапливать в int64.
+template<class T, class Acc = typename DefaultAccumulator<T>::type>
+class BasicMatrixMultiplier {
+private:
+    typedef typename KernelSet<T, Acc>::Packed Packed;
+    typedef MicroKernel<Packed, Acc> Kernel;
+
+    int M;                                 // строк в A и C
+    int K;                                 // столбцов A и строк B
+    int N;                                 // столбцов в B и C
+    ThreadPool* pool;                      // пул для multiplyParallelPool
+    std::unique_ptr<ThreadPool> ownedPool; // собственный пул при явном числе потоков
+    const Kernel* kernel;                  // микроядро для multiplyBlocked
+    BlockingParams blocking;               // размеры блоков под кэши
+    GemmScratch<Packed, Acc> scratch;      // буферы упаковки, переиспользуются между вызовами
+    std::unique_ptr<WorkStealingScheduler> stealer; // рабочие с деками, создаются при первом вызове
+    std::unique_ptr<ThreadPool> tunedPool; // пул настроенной конфигурации, если он не совпадает с общим
+    std::unique_ptr<WorkStealingScheduler> tunedStealer; // рабочие steal для tunedPool
+    StealingStats lastStealing;            // статистика последнего multiplyParallelWorkStealing
+    bool pinThreads;                       // привязка потоков pthread-версии к ядрам и узлам NUMA
+    NumaPlacement lastPlacement;           // размещение страниц после последнего привязанного запуска
+    std::string profilePath;               // профиль настройки; пусто — TuningProfile::defaultPath()
+    TunedConfig tuned;                     // конфигурация для multiply()
+    bool tunedReady;                       // tuned получена из профиля или перебором
+    bool tunedFromProfile;                 // последняя autoTune() нашла запись в профиле
+    const char* autoPath;                  // путь, выбранный последним multiplyAuto
+    VerifyMode verification;               // проверка результатов в testBlockSize
+    double falseAccept;                    // вероятность ложного принятия для Фрейвалдса
+    bool countTiles;                       // счётчики perf по плиткам multiplyParallelPool
+    std::vector<PerfSample> tileSamples;   // счётчики плиток последнего multiplyParallelPool
+    ChainBuffers<Acc> chainBuffers;        // промежуточные произведения multiplyChain
+    ChainPlan lastChain;                   // план последнего multiplyChain
+    PowerBuffers<Acc> powerBuffers;        // основание, результат и произведение для power
+    PowerBuffers<int64_t> powerModBuffers; // то же для powerMod
+    int lastPowerProducts;                 // умножений в последнем power/powerMod
+    std::vector<Matrix<Acc>> partialArena; // частичные суммы по K для multiplyParallelPool, между вызовами
+    bool lineTiles;                        // плитки по кэш-линиям C со своими буферами (setLineAlignedTiles)
+    DistributedReport lastDistributed;     // отчёт последнего multiplyDistributed
+    const QuantizedKernel* lastQuantized;  // ядро последнего multiplyQuantized
+
+    // Структура для передачи данных в поток
+    struct ThreadData {
+        MatrixView<const T> A;
+        MatrixView<const T> B;
+        MatrixView<Acc> C; // C или буфер частичных сумм своей части по K
+        TileRange range;
+        bool privateTile;  // считать в буфер потока (multiplyTilePrivate)
+    };
+
+    // Копия полосы строк A и всей B на узел NUMA потока, который их пишет
+    struct NodeCopy {
+        MatrixView<const T> srcA;
+        MatrixView<T> dstA;
+        MatrixView<const T> srcB;
+        MatrixView<T> dstB;
+    };
+
+    static void copyRows(MatrixView<const T> src, MatrixView<T> dst) {
+        for (int i = 0; i < src.rows(); i++) {
+            std::memcpy(dst.row(i), src.row(i), src.cols() * sizeof(T));
+        }
+    }
+
+    static void* copyToNode(void* arg) {
+        NodeCopy* copy = static_cast<NodeCopy*>(arg);
+        copyRows(copy->srcA, copy->dstA);
+        copyRows(copy->srcB, copy->dstB);
+        return nullptr;
+    }
+
+    // Статическая функция для потока
+    static void* multiplyBlock(void* arg) {
+        ThreadData* data = static_cast<ThreadData*>(arg);
+        computeTile(data->A, data->B, data->C, data->range, GemmOutput::Overwrite, data->privateTile);
+
+        delete data; // Освобождаем память
+        return nullptr;
+    }
+
+    // Вычисление плитки C[startRow..endRow) x [startCol..endCol) по k из [startK, endK)
+    static void multiplyTile(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+        const TileRange& range, GemmOutput output) {
+        for (int i = range.startRow; i < range.endRow; i++) {
+            const T* a = A.row(i);
+            Acc* c = C.row(i);
+            for (int j = range.startCol; j < range.endCol; j++) {
+                Acc sum = Acc();
+                for (int k = range.startK; k < range.endK; k++) {
+                    sum += static_cast<Acc>(a[k]) * static_cast<Acc>(B(k, j));
+                }
+                c[j] = output == GemmOutput::Accumulate ? c[j] + sum : sum;
+            }
+        }
+    }
+
+    // Плитка считается в буфер своего потока и переносится в C потоковыми записями:
+    // пока плитка считается, её линии C не переходят между ядрами, а запись в C
+    // идёт целыми линиями один раз
+    static void multiplyTilePrivate(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+        const TileRange& range, GemmOutput output) {
+        thread_local PackBuffer<Acc> local;
+        const int rows = range.endRow - range.startRow;
+        const int cols = range.endCol - range.startCol;
+        const int stride = Matrix<Acc>::paddedStride(cols);
+        MatrixView<Acc> tile(local.reserve(static_cast<size_t>(rows) * stride), rows, cols, stride);
+        MatrixView<Acc> target = C.tile(range.startRow, range.startCol, rows, cols);
+        if (output == GemmOutput::Accumulate) {
+            for (int i = 0; i < rows; i++) {
+                std::copy(target.row(i), target.row(i) + cols, tile.row(i));
+            }
+        }
+        TileRange localRange = { 0, rows, 0, cols, range.startK, range.endK, range.kPart };
+        multiplyTile(A.rowRange(range.startRow, range.endRow), B.tile(0, range.startCol, B.rows(), cols), tile,
+            localRange, output);
+        storeNonTemporal<Acc>(tile, target);
+    }
+
+    static void computeTile(MatrixView<const T> A, MatrixView<const T> B, MatrixView<Acc> C,
+        const TileRange& range, GemmOutput output, bool privateTile) {
+        if (privateTile) {
+            multiplyTilePrivate(A, B, C, range, output);
+        } else {
+            multiplyTile(A, B, C, range, output);
+        }
+    }
+
+    // Проверка, что A имеет размер M x K, а B — K x N
+    void checkOperands(const Matrix<T>& A, const Matrix<T>& B) const {
+        if (A.rows() != M || A.cols() != K || B.rows() != K || B.cols() != N) {
+            throw std::invalid_argument("MatrixMultiplier: operand shape does not match M x K * K x N");
+        }
+    }
+
+    // Готовая матрица результата: M x N и не совпадает с операндом
+    void checkOutput(const Matrix<T>& A, const Matrix<T>& B, const Matrix<Acc>& C) const {
+        checkOperands(A, B);
+        if (C.rows() != M || C.cols() != N) {
+            throw std::invalid_argument("MatrixMultiplier: output shape does not match M x N");
+        }
+        const void* c = C.data();
+        if (c != nullptr && (c == static_cast<const void*>(A.data()) || c == static_cast<const void*>(B.data()))) {
+            throw std::invalid_argument("MatrixMultiplier: output must not alias an operand");
+        }
+    }
+
+    // Для степени: квадратный умножитель и A размера M x M
+    void checkSquare(const Matrix<T>& A) const {
+        if (M != K || K != N || A.rows() != M || A.cols() != M) {
+            throw std::invalid_argument("MatrixMultiplier: power needs a square multiplier and an M x M matrix");
+        }
+    }
+
+    // blockSize > 0 — фиксированные блоки (при lineTiles — по целым кэш-линиям C),
+    // иначе разбиение под форму задачи и число потоков
+    Partition makePartition(int blockSize) const {
+        if (blockSize > 0) {
+            if (lineTiles) {
+                return Partition::lineAligned(M, N, K, blockSize, lineElements());
+            }
+            return Partition::fixed(M, N, K, blockSize);
+        }
+        return Partition::forShape(M, N, K, threadCount());
+    }
+
+    // Буферы частичных сумм для частей по K с номером > 0
+    static std::vector<Matrix<Acc>> makePartials(const Partition& partition) {
+        std::vector<Matrix<Acc>> partials;
+        for (int p = 1; p < partition.kParts; p++) {
+            partials.emplace_back(partition.M, partition.N);
+        }
+        return partials;
+    }
+
+    // Те же буферы из арены: переиспользуются, если разбиение той же формы
+    static void reservePartials(const Partition& partition, std::vector<Matrix<Acc>>& partials) {
+        partials.resize(std::max(partition.kParts - 1, 0));
+        for (Matrix<Acc>& partial : partials) {
+            if (partial.rows() != partition.M || partial.cols() != partition.N) {
+                partial = Matrix<Acc>::uninitialized(partition.M, partition.N);
+            }
+        }
+    }
+
+    static MatrixView<Acc> tileTarget(MatrixView<Acc> C, std::vector<Matrix<Acc>>& partials, int kPart) {
+        return kPart == 0 ? C : partials[kPart - 1].view();
+    }
+
+    // Сложение частичных сумм по K в C
+    static void reducePartials(MatrixView<Acc> C, const std::vector<Matrix<Acc>>& partials) {
+        for (const Matrix<Acc>& partial : partials) {
+            for (int i = 0; i < C.rows(); i++) {
+                const Acc* p = partial.row(i);
+                Acc* c = C.row(i);
+                for (int j = 0; j < C.cols(); j++) {
+                    c[j] += p[j];
+                }
+            }
+        }
+    }
+
+    // Плитки разбиения на пуле в C; partials — буферы частичных сумм (reservePartials),
+    // samples — счётчики perf по плиткам (nullptr — без них). Плитки части 0 пишут
+    // или прибавляют прямо в C, остальные части заполняют свои буферы целиком.
+    // Память в куче не выделяется.
+    static void multiplyPartition(ThreadPool& pool, const Partition& partition, MatrixView<const T> a,
+        MatrixView<const T> b, MatrixView<Acc> C, std::vector<Matrix<Acc>>& partials,
+        std::vector<PerfSample>* samples, GemmOutput output, bool privateTiles) {
+        pool.parallelFor(partition.tiles(), [&](int tile) {
+            TileRange range = partition.tile(tile);
+            const GemmOutput tileOutput = range.kPart == 0 ? output : GemmOutput::Overwrite;
+            if (samples) {
+                // Счётчики своего потока открываются один раз на поток
+                thread_local PerfCounters counters(PerfCounters::Thread);
+                counters.start();
+                computeTile(a, b, tileTarget(C, partials, range.kPart), range, tileOutput, privateTiles);
+                (*samples)[tile] = counters.stop();
+            } else {
+                computeTile(a, b, tileTarget(C, partials, range.kPart), range, tileOutput, privateTiles);
+            }
+        });
+
+        reducePartials(C, partials);
+    }
+
+    // То же разбиение, но каждая плитка считается блочным ядром с упаковкой
+    // (буферы упаковки свои у каждого потока). Ядро и параметры блоков передаются
+    // явно, чтобы задача не зависела от умножителя.
+    static Matrix<Acc> multiplyPartitionPacked(ThreadPool& pool, const Partition& partition,
+        const Kernel& tileKernel, const BlockingParams& tileBlocking, MatrixView<const T> a, MatrixView<const T> b) {
+        Matrix<Acc> C(partition.M, partition.N);
+        std::vector<Matrix<Acc>> partials = makePartials(partition);
+
+        pool.parallelFor(partition.tiles(), [&](int tile) {
+            thread_local GemmScratch<Packed, Acc> localScratch;
+            TileRange range = partition.tile(tile);
+            const int rows = range.endRow - range.startRow;
+            const int cols = range.endCol - range.startCol;
+            const int depth = range.endK - range.startK;
+            gemmBlocked(tileKernel, tileBlocking, a.tile(range.startRow, range.startK, rows, depth),
+                b.tile(range.startK, range.startCol, depth, cols),
+                tileTarget(C.view(), partials, range.kPart).tile(range.startRow, range.startCol, rows, cols),
+                localScratch);
+        });
+
+        reducePartials(C.view(), partials);
+        return C;
+    }
+
+    // IPC и промахи на операцию (2*M*N*K операций); без счётчиков — причина недоступности
+    void printCounters(const PerfCounters& counters, const PerfSample& sample) const {
+        if (sample.empty()) {
+            if (!perfUnavailableReported) {
+                std::cout << "  счётчики perf недоступны: " << counters.unavailableReason() << std::endl;
+                perfUnavailableReported = true;
+            }
+            return;
+        }
+        const double flops = 2.0 * M * N * K;
+        std::cout << "  IPC: " << std::setprecision(2) << sample.ipc() << ", промахов на операцию:"
+                  << std::scientific << std::setprecision(2)
+                  << " L1d " << sample.perFlop(kPerfL1dMisses, flops)
+                  << ", LLC " << sample.perFlop(kPerfLlcMisses, flops)
+                  << ", dTLB " << sample.perFlop(kPerfDtlbMisses, flops) << std::fixed << std::endl;
+    }
+
+    static Matrix<Acc> widen(const Matrix<T>& X) {
+        Matrix<Acc> wide(X.rows(), X.cols());
+        for (int i = 0; i < X.rows(); i++) {
+            const T* x = X.row(i);
+            Acc* w = wide.row(i);
+            for (int j = 0; j < X.cols(); j++) {
+                w[j] = static_cast<Acc>(x[j]);
+            }
+        }
+        return wide;
+    }
+
+    template<class P>
+    void runStrassen(const MicroKernel<P, Acc>& baseKernel, const BlockingParams& baseBlocking,
+        MatrixView<const Acc> A, MatrixView<const Acc> B, MatrixView<Acc> C, const StrassenOptions& options) {
+        auto base = [&](MatrixView<const Acc> a, MatrixView<const Acc> b, MatrixView<Acc> c) {
+            thread_local GemmScratch<P, Acc> localScratch;
+            for (int i = 0; i < c.rows(); i++) {
+                std::fill(c.row(i), c.row(i) + c.cols(), Acc());
+            }
+            gemmBlocked(baseKernel, baseBlocking, a, b, c, localScratch);
+        };
+        strassenWinograd<Acc>(A, B, C, options, *pool, base);
+    }
+
+    // Полоса строк A каждого узла и отдельная копия B на каждый узел пишутся потоком,
+    // привязанным к CPU этого узла, поэтому страницы оказываются на нём
+    static void replicateToNodes(const Matrix<T>& A, const Matrix<T>& B, const NumaTopology& numa,
+        Matrix<T>& localA, std::vector<Matrix<T>>& localB) {
+        const int nodes = numa.nodes();
+        std::vector<NodeCopy> copies(nodes);
+        std::vector<pthread_t> threads(nodes);
+        std::vector<bool> started(nodes, false);
+        for (int node = 0; node < nodes; node++) {
+            localB.push_back(Matrix<T>::uninitialized(B.rows(), B.cols()));
+        }
+        for (int node = 0; node < nodes; node++) {
+            int begin = numaBandStart(A.rows(), nodes, node);
+            int end = numaBandStart(A.rows(), nodes, node + 1);
+            copies[node] = NodeCopy{ A.view().rowRange(begin, end), localA.view().rowRange(begin, end),
+                B.view(), localB[node].view() };
+            started[node] = startPinnedThread(&threads[node], numa.nodeCpus[node], copyToNode, &copies[node]);
+            if (!started[node]) {
+                copyToNode(&copies[node]);
+            }
+        }
+        for (int node = 0; node < nodes; node++) {
+            if (started[node]) {
+                pthread_join(threads[node], nullptr);
+            }
+        }
+    }
+
+    static std::string typeKey() {
+        return std::string(elementTypeName<T>()) + "->" + elementTypeName<Acc>();
+    }
+
+    // Пул, микроядро и рабочие steal конфигурации на время одного вызова:
+    // собственные настройки умножителя (setThreadCount, setKernel) восстанавливаются
+    class TunedScope {
+    public:
+        TunedScope(BasicMatrixMultiplier& owner, const TunedConfig& config)
+            : owner_(owner), pool_(owner.pool), kernel_(owner.kernel), blocking_(owner.blocking) {
+            owner.pool = &owner.poolForTuned(config.threads);
+            if (const Kernel* found = findKernel<T, Acc>(config.kernel)) {
+                owner.setKernel(*found);
+            }
+            owner.stealer.swap(owner.tunedStealer);
+        }
+
+        ~TunedScope() {
+            owner_.stealer.swap(owner_.tunedStealer);
+            owner_.pool = pool_;
+            owner_.kernel = kernel_;
+            owner_.blocking = blocking_;
+        }
+
+        TunedScope(const TunedScope&) = delete;
+        TunedScope& operator=(const TunedScope&) = delete;
+
+    private:
+        BasicMatrixMultiplier& owner_;
+        ThreadPool* pool_;
+        const Kernel* kernel_;
+        BlockingParams blocking_;
+    };
+
+    // Общий пул, если потоков столько же; иначе отдельный, пересоздаётся при смене числа
+    ThreadPool& poolForTuned(int threads) {
+        if (threads <= 0 || threads == ThreadPool::shared().size()) {
+            return ThreadPool::shared();
+        }
+        if (!tunedPool || tunedPool->size() != threads) {
+            tunedPool.reset(new ThreadPool(threads));
+        }
+        return *tunedPool;
+    }
+
+    Matrix<Acc> runTuned(const TunedConfig& config, const Matrix<T>& A, const Matrix<T>& B) {
+        TunedScope scope(*this, config);
+        if (config.variant == "strassen") {
+            return multiplyStrassen(A, B, config.block);
+        }
+        if (config.variant == "pool") {
+            return multiplyParallelPool(A, B, config.block);
+        }
+        if (config.variant == "steal") {
+            return multiplyParallelWorkStealing(A, B, config.block);
+        }
+        return multiplyBlocked(A, B);
+    }
+
+    // Медиана трёх замеров после прогрева. Если уже прогрев дольше limitUs,
+    // кандидат заведомо проигрывает и сразу отбрасывается.
+    double timeTuned(const TunedConfig& config, const Matrix<T>& A, const Matrix<T>& B, double limitUs) {
+        double samples[3];
+        for (int i = -1; i < 3; i++) {
+            auto start = std::chrono::steady_clock::now();
+            runTuned(config, A, B);
+            auto end = std::chrono::steady_clock::now();
+            double us = std::chrono::duration<double, std::micro>(end - start).count();
+            if (i < 0 && us > limitUs) {
+                return us;
+            }
+            if (i >= 0) {
+                samples[i] = us;
+            }
+        }
+        std::sort(samples, samples + 3);
+        return samples[1];
+    }
+
+    // Перебор: все микроядра блочного умножения, Штрассен на крупных формах,
+    // пул и кража работы по числу потоков 1, 2, 4, ... и размерам блока
+    TunedConfig searchConfig() {
+        Matrix<T> A(M, K);
+        Matrix<T> B(K, N);
+        fillMatrixRandom(A, 1);
+        fillMatrixRandom(B, 2);
+
+        TunedConfig best = { "blocked", kernel->name, 0, 1, std::numeric_limits<double>::infinity() };
+        auto consider = [&](const TunedConfig& candidate) {
+            double us = timeTuned(candidate, A, B, 3.0 * best.medianUs);
+            if (us < best.medianUs) {
+                best = candidate;
+                best.medianUs = us;
+            }
+            return us;
+        };
+
+        for (const Kernel* candidate : availableKernels<T, Acc>()) {
+            consider(TunedConfig{ "blocked", candidate->name, 0, 1, 0.0 });
+        }
+        const int hardware = ThreadPool::shared().size();
+        if (std::min(M, std::min(K, N)) >= 512) {
+            for (int cutoff : { 256, 512 }) {
+                consider(TunedConfig{ "strassen", best.kernel, cutoff, hardware, 0.0 });
+            }
+        }
+
+        std::vector<int> threadCounts;
+        for (int threads = 1; threads < hardware; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(hardware);
+        for (int threads : threadCounts) {
+            for (const char* variant : { "pool", "steal" }) {
+                // Разбиение под форму первым: если оно сильно хуже лучшего, блоки не перебираем
+                if (consider(TunedConfig{ variant, "-", 0, threads, 0.0 }) > 3.0 * best.medianUs) {
+                    continue;
+                }
+                for (int block = 16; block <= std::max(M, N) && block <= 256; block *= 2) {
+                    consider(TunedConfig{ variant, "-", block, threads, 0.0 });
+                }
+            }
+        }
+        return best;
+    }
+
+public:
+    // Квадратные матрицы size x size.
+    // threads <= 0: общий пул процесса размером hardware_concurrency()
+    explicit BasicMatrixMultiplier(int size, int threads = 0)
+        : BasicMatrixMultiplier(size, size, size, threads) {}
+
+    // Прямоугольное произведение (m x k) * (k x n)
+    BasicMatrixMultiplier(int m, int k, int n, int threads = 0)
+        : M(m), K(k), N(n), pool(&ThreadPool::shared()), kernel(&bestKernel<T, Acc>()),
+          blocking(BlockingParams::forKernel(kernel->mr, kernel->nr, sizeof(Packed))),
+          pinThreads(false), lastPlacement(), tuned(), tunedReady(false), tunedFromProfile(false),
+          autoPath("dense"), verification(VerifyMode::Reference), falseAccept(1e-9),
+          countTiles(false), lastPowerProducts(0), lineTiles(false), lastDistributed(),
+          lastQuantized(nullptr) {
+        setThreadCount(threads);
+    }
+
+    int rows() const { return M; }
+    int inner() const { return K; }
+    int cols() const { return N; }
+
+    // Число рабочих потоков пула не зависит от размера блока
+    void setThreadCount(int threads) {
+        if (threads <= 0) {
+            ownedPool.reset();
+            pool = &ThreadPool::shared();
+        } else if (threads != pool->size() || !ownedPool) {
+            ownedPool.reset(new ThreadPool(threads));
+            pool = ownedPool.get();
+        }
+    }
+
+    int threadCount() const { return pool->size(); }
+
+    // Плитки без ложного разделения для std::thread, pthread и пула: при blockSize > 0
+    // ширина плитки округляется до целых кэш-линий C, каждая плитка считается в буфер
+    // своего потока и переносится в C потоковыми записями (storeNonTemporal)
+    void setLineAlignedTiles(bool enabled) { lineTiles = enabled; }
+    bool lineAlignedTiles() const { return lineTiles; }
+
+    // Элементов C в одной кэш-линии
+    static int lineElements() { return static_cast<int>(kMatrixAlignment / sizeof(Acc)); }
+
+    // Разбиение, которое параллельные варианты используют для blockSize
+    // (sharedLines() — линии C, в которые пишут несколько плиток)
+    Partition partition(int blockSize) const { return makePartition(blockSize); }
+
+    // Микроядро для multiplyBlocked; по умолчанию самое широкое из поддерживаемых
+    void setKernel(const Kernel& microKernel) {
+        kernel = &microKernel;
+        blocking = BlockingParams::forKernel(kernel->mr, kernel->nr, sizeof(Packed));
+    }
+
+    const Kernel& currentKernel() const { return *kernel; }
+
+    // Способ проверки результатов в testBlockSize; falseAcceptProbability — для Фрейвалдса
+    void setVerification(VerifyMode mode, double falseAcceptProbability = 1e-9) {
+        freivaldsTrials(falseAcceptProbability);
+        verification = mode;
+        falseAccept = falseAcceptProbability;
+    }
+
+    VerifyMode verificationMode() const { return verification; }
+
+    // Профиль для autoTune(); пустой путь — TuningProfile::defaultPath()
+    void setTuningProfile(const std::string& path) {
+        profilePath = path;
+        tunedReady = false;
+    }
+
+    // Подбор варианта, микроядра, размера блока и числа потоков для этой формы и типа.
+    // Если профиль уже содержит запись для текущего отпечатка оборудования, она берётся
+    // без замеров; иначе (или при force) выполняется перебор и профиль дополняется.
+    // Найденные пул и микроядро действуют только в multiply() и плотном пути
+    // multiplyAuto; остальные методы по-прежнему берут setThreadCount и setKernel.
+    const TunedConfig& autoTune(bool force = false) {
+        const HardwareFingerprint& fingerprint = HardwareFingerprint::detect();
+        TuningProfile profile(profilePath.empty() ? TuningProfile::defaultPath() : profilePath);
+        tunedFromProfile = !force && profile.find(fingerprint.hash, typeKey(), M, K, N, tuned);
+        if (!tunedFromProfile) {
+            tuned = searchConfig();
+            profile.store(fingerprint, typeKey(), M, K, N, tuned);
+            if (!profile.save()) {
+                std::cerr << "Не удалось сохранить профиль настройки: " << profile.path() << std::endl;
+            }
+        }
+        tunedReady = true;
+        return tuned;
+    }
+
+    const TunedConfig& tunedConfig() const { return tuned; }
+    bool tunedConfigFromProfile() const { return tunedFromProfile; }
+
+    // Умножение в настроенной конфигурации; при первом вызове выполняется autoTune()
+    Matrix<Acc> multiply(const Matrix<T>& A, const Matrix<T>& B) {
+        if (!tunedReady) {
+            autoTune();
+        }
+        return runTuned(tuned, A, B);
+    }
+
+    // Привязка потоков multiplyParallelPthread: полосы строк делятся между узлами NUMA,
+    // поток плитки закрепляется за ядром узла своих строк и сам первым пишет свою часть C.
+    // На нескольких узлах полоса A и копия B переносятся на узел потоком этого узла.
+    void setPinThreads(bool pin) { pinThreads = pin; }
+    bool pinnedThreads() const { return pinThreads; }
+
+    // Страницы C (и копий A) на своём и чужом узле после последнего привязанного запуска
+    const NumaPlacement& numaPlacement() const { return lastPlacement; }
+
+    // Обычное умножение матриц (последовательное)
+    Matrix<Acc> multiplySequential(const Matrix<T>& A, const Matrix<T>& B) {
+        checkOperands(A, B);
+        Matrix<Acc> C = Matrix<Acc>::uninitialized(M, N);
+        multiplySequential(A, B, C);
+        return C;
+    }
+
+    // Варианты с готовой матрицей C (M x N, не операнд): результат записывается
+    // в неё или прибавляется к ней (GemmOutput::Accumulate), память в куче не
+    // выделяется, если рабочие буферы умножителя уже подходят по размеру
+    void multiplySequential(const Matrix<T>& A, const Matrix<T>& B, Matrix<Acc>& C,
+        GemmOutput output = GemmOutput::Overwrite) {
+        checkOutput(A, B, C);
+        for (int i = 0; i < M; i++) {
+            const T* a = A.row(i);
+            Acc* c = C.row(i);
+            for (int j = 0; j < N; j++) {
+                Acc sum = output == GemmOutput::Accumulate ? c[j] : Acc();
+                for (int k = 0; k < K; k++) {
+                    sum += static_cast<Acc>(a[k]) * static_cast<Acc>(B(k, j));
+                }
+                c[j] = sum;
+            }
+        }
+    }
+
+    // Последовательное умножение с блокированием под кэши и упаковкой панелей B
+    Matrix<Acc> multiplyBlocked(const Matrix<T>& A, const Matrix<T>& B) {
+        checkOperands(A, B);
+        Matrix<Acc> C(M, N);
+        gemmBlocked(*kernel, blocking, A.view(), B.view(), C.view(), scratch);
+        return C;
+    }
+
+    // Буферы упаковки — scratch умножителя, растут только при первом вызове
+    void multiplyBlocked(const Matrix<T>& A, const Matrix<T>& B, Matrix<Acc>& C,
+        GemmOutput output = GemmOutput::Overwrite) {
+        checkOutput(A, B, C);
+        if (output == GemmOutput::Overwrite) {
+            for (int i = 0; i < M; i++) {
+                std::fill(C.row(i), C.row(i) + N, Acc());
+            }
+        }
+        gemmBlocked(*kernel, blocking, A.view(), B.view(), C.view(), scratch);
+    }
+
+    // Рекурсивное умножение Штрассена–Винограда.
+    // Ниже cutoff работает блочное ядро; 7 произведений верхних уровней считаются на пуле.
+    // Суммы подматриц могут выйти за диапазон T, поэтому при T != Acc операнды
+    // сначала расширяются до Acc.
+    Matrix<Acc> multiplyStrassen(const Matrix<T>& A, const Matrix<T>& B, int cutoff = 512) {
+        checkOperands(A, B);
+        Matrix<Acc> C(M, N);
+
+        StrassenOptions options;
+        options.cutoff = cutoff;
+        options.parallelLevels = threadCount() > 7 ? 2 : (threadCount() > 1 ? 1 : 0);
+
+        if constexpr (std::is_same<T, Acc>::value) {
+            runStrassen(*kernel, blocking, A.view(), B.view(), C.view(), options);
+        } else {
+            const auto& wideKernel = bestKernel<Acc, Acc>();
+            BlockingParams wideBlocking = BlockingParams::forKernel(wideKernel.mr, wideKernel.nr,
+                sizeof(typename KernelSet<Acc, Acc>::Packed));
+            Matrix<Acc> wideA = widen(A);
+            Matrix<Acc> wideB = widen(B);
+            runStrassen(wideKernel, wideBlocking, wideA.view(), wideB.view(), C.view(), options);
+        }
+        return C;
+    }
+
+    // Многопоточное умножение с блочным разбиением (pthread).
+    // blockSize <= 0 — разбиение под форму задачи на threadCount() плиток
+    Matrix<Acc> multiplyParallelPthread(const Matrix<T>& A, const Matrix<T>& B, int blockSize) {
+        checkOperands(A, B);
+        // При привязке C не заполняется здесь: страницы первыми пишут потоки плиток
+        Matrix<Acc> C = pinThreads ? Matrix<Acc>::uninitialized(M, N) : Matrix<Acc>(M, N);
+        Partition partition = makePartition(blockSize);
+        std::vector<Matrix<Acc>> partials = makePartials(partition);
+
+        const NumaTopology& numa = NumaTopology::detect();
+        const bool replicate = pinThreads && numa.multiNode();
+        Matrix<T> localA;
+        std::vector<Matrix<T>> localB;
+        if (replicate) {
+            localA = Matrix<T>::uninitialized(M, K);
+            replicateToNodes(A, B, numa, localA, localB);
+        }
+        std::vector<size_t> nextCpu(numa.nodes(), 0);
+
+        int totalThreads = partition.tiles();
+        std::vector<pthread_t> threads(totalThreads);
+        std::vector<bool> started(totalThreads, false);
+        bool creationFailed = false;
+
+        // Создаем потоки для каждого блока
+        for (int tile = 0; tile < totalThreads; tile++) {
+            TileRange range = partition.tile(tile);
+
+            // Создаем данные для потока
+            ThreadData* data = new ThreadData{ A.view(), B.view(),
+                tileTarget(C.view(), partials, range.kPart), range, lineTiles };
+
+            // Создаем поток (при привязке — на ядре узла, которому принадлежат строки плитки)
+            int created;
+            if (pinThreads) {
+                int node = numaNodeForRow(range.startRow, M, numa.nodes());
+                const std::vector<int>& cpus = numa.nodeCpus[node];
+                std::vector<int> core(1, cpus[nextCpu[node]++ % cpus.size()]);
+                if (replicate) {
+                    data->A = localA.view();
+                    data->B = localB[node].view();
+                }
+                created = startPinnedThread(&threads[tile], core, multiplyBlock, data) ? 0 : -1;
+            } else {
+                created = pthread_create(&threads[tile], nullptr, multiplyBlock, data);
+            }
+            if (created != 0) {
+                if (!creationFailed) {
+                    std::cerr << "Ошибка создания потока! Блоки досчитываются в текущем потоке" << std::endl;
+                    creationFailed = true;
+                }
+                multiplyBlock(data);
+            } else {
+                started[tile] = true;
+            }
+        }
+
+        // Ждем завершения всех потоков
+        for (int i = 0; i < totalThreads; i++) {
+            if (started[i]) {
+                pthread_join(threads[i], nullptr);
+            }
+        }
+
+        reducePartials(C.view(), partials);
+        if (pinThreads) {
+            lastPlacement = numaRowPlacement<Acc>(C.view(), numa);
+            if (replicate) {
+                lastPlacement += numaRowPlacement<T>(localA.view(), numa);
+            }
+        }
+        return C;
+    }
+
+    // Многопоточное умножение с использованием std::thread
+    Matrix<Acc> multiplyParallelStdThread(const Matrix<T>& A, const Matrix<T>& B, int blockSize) {
+        checkOperands(A, B);
+        Matrix<Acc> C(M, N);
+        Partition partition = makePartition(blockSize);
+        std::vector<Matrix<Acc>> partials = makePartials(partition);
+        std::vector<std::thread> threads;
+
+        // Создаем потоки для каждого блока
+        for (int tile = 0; tile < partition.tiles(); tile++) {
+            auto body = [&, tile]() {
+                TileRange range = partition.tile(tile);
+                computeTile(A.view(), B.view(), tileTarget(C.view(), partials, range.kPart), range,
+                    GemmOutput::Overwrite, lineTiles);
+            };
+            try {
+                threads.emplace_back(body);
+            } catch (const std::system_error&) {
+                // Лимит потоков исчерпан: считаем блок в текущем потоке
+                body();
+            }
+        }
+
+        // Ждем завершения всех потоков
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        reducePartials(C.view(), partials);
+        return C;
+    }
+
+    // Многопоточное умножение на постоянном пуле: блоки ставятся в очередь как задачи
+    Matrix<Acc> multiplyParallelPool(const Matrix<T>& A, const Matrix<T>& B, int blockSize) {
+        checkOperands(A, B);
+        Matrix<Acc> C = Matrix<Acc>::uninitialized(M, N);
+        multiplyParallelPool(A, B, C, blockSize);
+        return C;
+    }
+
+    // Частичные суммы по K берутся из арены умножителя, задачи пула — без выделений
+    void multiplyParallelPool(const Matrix<T>& A, const Matrix<T>& B, Matrix<Acc>& C, int blockSize,
+        GemmOutput output = GemmOutput::Overwrite) {
+        checkOutput(A, B, C);
+        Partition partition = makePartition(blockSize);
+        reservePartials(partition, partialArena);
+        tileSamples.assign(countTiles ? partition.tiles() : 0, PerfSample());
+        multiplyPartition(*pool, partition, A.view(), B.view(), C.view(), partialArena,
+            countTiles ? &tileSamples : nullptr, output, lineTiles);
+    }
+
+    // Счётчики perf по каждой плитке multiplyParallelPool (такты, инструкции, промахи):
+    // видно, какие плитки упираются в память. Пусто, если сбор выключен.
+    void setTileCounters(bool enabled) { countTiles = enabled; }
+    const std::vector<PerfSample>& tileCounters() const { return tileSamples; }
+
+    // Асинхронное умножение: задача ставится в очередь пула умножителя и сразу
+    // возвращает MatrixFuture. Плитки разбиения multiplyParallelPool считаются блочным
+    // ядром (вложенный parallelFor на том же пуле) без обращения к состоянию умножителя,
+    // поэтому можно запустить несколько произведений подряд и ждать их через
+    // waitAny/waitAll или продолжить через then(). Операнды разделяются через shared_ptr: один A
+    // для нескольких B не копируется. Пул должен жить до завершения операций
+    // и их продолжений (собственный пул умножителя — пока жив умножитель).
+    MatrixFuture<Matrix<Acc>> multiplyAsync(std::shared_ptr<const Matrix<T>> A,
+        std::shared_ptr<const Matrix<T>> B, int blockSize = 0) {
+        if (!A || !B) {
+            throw std::invalid_argument("MatrixMultiplier: null operand");
+        }
+        checkOperands(*A, *B);
+        Partition partition = makePartition(blockSize);
+        ThreadPool* executor = pool;
+        const Kernel* tileKernel = kernel;
+        BlockingParams tileBlocking = blocking;
+        return submitAsync(*pool, [executor, partition, tileKernel, tileBlocking, A, B]() {
+            return multiplyPartitionPacked(*executor, partition, *tileKernel, tileBlocking, A->view(), B->view());
+        });
+    }
+
+    // Операнды по значению: передайте std::move, чтобы не копировать
+    MatrixFuture<Matrix<Acc>> multiplyAsync(Matrix<T> A, Matrix<T> B, int blockSize = 0) {
+        return multiplyAsync(std::make_shared<const Matrix<T>>(std::move(A)),
+            std::make_shared<const Matrix<T>>(std::move(B)), blockSize);
+    }
+
+    // Умножение на нескольких процессах (SUMMA, блочно-циклическое распределение):
+    // рабочие — дочерние процессы, обмен через общую память или сокеты Unix,
+    // передача панелей следующего шага идёт параллельно со счётом текущего
+    Matrix<Acc> multiplyDistributed(const Matrix<T>& A, const Matrix<T>& B,
+        const DistributedOptions& options = DistributedOptions()) {
+        checkOperands(A, B);
+        Matrix<Acc> C(M, N);
+        ::multiplyDistributed(*kernel, blocking, A.view(), B.view(), C.view(), options, lastDistributed);
+        return C;
+    }
+
+    // Решётка, время и объём обменов каждого рабочего последнего multiplyDistributed
+    const DistributedReport& distributedReport() const { return lastDistributed; }
+
+    // Умножение в 8 битах: A -> u8, B -> s8, суммы в int32, затем обратно в Acc.
+    // Целые операнды квантуются без потерь, и результат совпадает с multiplySequential,
+    // если A умещается в окно из 256 значений, а B — в [-128, 127] (иначе invalid_argument);
+    // вещественные — приближённо, с ошибкой порядка шага квантования.
+    Matrix<Acc> multiplyQuantized(const Matrix<T>& A, const Matrix<T>& B) {
+        checkOperands(A, B);
+        const int levels = std::is_integral<T>::value ? 255 : quantizedActivationLevels();
+        const QuantizedMatrix<uint8_t> qa = quantizeUnsigned(A.view(), levels);
+        const QuantizedMatrix<int8_t> qb = quantizeSigned(B.view());
+        lastQuantized = &quantizedKernelFor(qa.maxMagnitude, qb.maxMagnitude);
+        Matrix<int32_t> acc = Matrix<int32_t>::uninitialized(M, N);
+        gemmQuantized(*lastQuantized, qa, qb, acc.view(), *pool);
+        Matrix<Acc> C = Matrix<Acc>::uninitialized(M, N);
+        dequantize(acc.view(), qa, qb, C.view());
+        return C;
+    }
+
+    // Ядро последнего multiplyQuantized (nullptr, если его ещё не было)
+    const char* quantizedKernelName() const { return lastQuantized ? lastQuantized->name : nullptr; }
+
+    // Умножение матриц из файлов: C (M x N, файл pathC) = A (M x K) * B (K x N).
+    // Плитки A, B и C отображаются через mmap и обходятся так, что в памяти находятся
+    // только полоса плиток A текущей строки и по одной плитке B и C на поток;
+    // прочитанные плитки снимаются madvise(DONTNEED), следующие запрашиваются заранее
+    // (WILLNEED). Страницы файлов вытесняются без swap, поэтому операнды могут быть
+    // больше физической памяти. Плитки A по K должны совпадать с плитками B по K.
+    // workingSetBytes ограничивает число одновременно считаемых плиток C; если в него
+    // не помещается полоса A вместе с одной плиткой B и C — invalid_argument.
+    void multiplyOutOfCore(const std::string& pathA, const std::string& pathB, const std::string& pathC,
+        size_t workingSetBytes = size_t(256) << 20) {
+        MappedMatrix<T> A = MappedMatrix<T>::open(pathA);
+        MappedMatrix<T> B = MappedMatrix<T>::open(pathB);
+        if (A.rows() != M || A.cols() != K || B.rows() != K || B.cols() != N) {
+            throw std::invalid_argument("MatrixMultiplier: operand files do not match M x K * K x N");
+        }
+        if (A.tileCols() != B.tileRows()) {
+            throw std::invalid_argument("MatrixMultiplier: A and B files use different tiles along K");
+        }
+
+        const size_t panelBytes = static_cast<size_t>(A.tileRows()) * K * sizeof(T);
+        const size_t tileBytes = static_cast<size_t>(B.tileRows()) * B.tileCols() * sizeof(T)
+            + static_cast<size_t>(A.tileRows()) * B.tileCols() * sizeof(Acc) * 2;
+        // Полоса A и плитки файла — единицы madvise и не делятся, поэтому бюджет
+        // меньше полосы и одной плитки B и C выполнить нельзя; файл C при этом не создаётся
+        if (workingSetBytes < panelBytes || workingSetBytes - panelBytes < tileBytes) {
+            throw std::invalid_argument("MatrixMultiplier: working set is smaller than a row panel of A plus one tile");
+        }
+        const size_t budget = workingSetBytes - panelBytes;
+        // Сужение до int только после ограничения числом потоков: при большом бюджете
+        // частное не помещается в int
+        const size_t fit = std::min(budget / tileBytes, static_cast<size_t>(threadCount()));
+        const int batch = std::max(1, static_cast<int>(fit));
+        const int kTiles = A.gridCols();
+        MappedMatrix<Acc> C = MappedMatrix<Acc>::create(pathC, M, N, A.tileRows(), B.tileCols());
+
+        for (int i = 0; i < C.gridRows(); i++) {
+            A.prefetchTile(i, 0);
+            for (int j0 = 0; j0 < C.gridCols(); j0 += batch) {
+                int count = std::min(batch, C.gridCols() - j0);
+                pool->parallelFor(count, [&](int index) {
+                    thread_local GemmScratch<Packed, Acc> localScratch;
+                    thread_local PackBuffer<Acc> localAcc;
+                    const int j = j0 + index;
+                    MatrixView<Acc> target = C.tile(i, j);
+                    // Буфер потока рассчитан на полную плитку C и переиспользуется для всех плиток
+                    const int stride = Matrix<Acc>::paddedStride(C.tileCols());
+                    MatrixView<Acc> acc(localAcc.reserve(static_cast<size_t>(C.tileRows()) * stride),
+                        target.rows(), target.cols(), stride);
+                    for (int r = 0; r < acc.rows(); r++) {
+                        std::fill(acc.row(r), acc.row(r) + acc.cols(), Acc());
+                    }
+                    B.prefetchTile(0, j);
+                    for (int p = 0; p < kTiles; p++) {
+                        if (p + 1 < kTiles) {
+                            A.prefetchTile(i, p + 1);
+                            B.prefetchTile(p + 1, j);
+                        }
+                        gemmBlocked(*kernel, blocking, MatrixView<const T>(A.tile(i, p)),
+                            MatrixView<const T>(B.tile(p, j)), acc, localScratch);
+                        B.releaseTile(p, j);
+                    }
+                    for (int r = 0; r < target.rows(); r++) {
+                        std::memcpy(target.row(r), acc.row(r), target.cols() * sizeof(Acc));
+                    }
+                    C.releaseTile(i, j);
+                });
+            }
+            for (int p = 0; p < kTiles; p++) {
+                A.releaseTile(i, p);
+            }
+        }
+        C.flush();
+    }
+
+    // Разреженные операнды: преобразование из плотной матрицы идёт параллельно на пуле
+    CsrMatrix<T> toCsr(const Matrix<T>& A) { return ::toCsr(A, *pool); }
+    CscMatrix<T> toCsc(const Matrix<T>& B) { return ::toCsc(B, *pool); }
+
+    // A (CSR) * B (плотная): nnz(A) * N умножений вместо M * K * N
+    Matrix<Acc> multiplySparse(const CsrMatrix<T>& A, const Matrix<T>& B) {
+        if (A.rows != M || A.cols != K || B.rows() != K || B.cols() != N) {
+            throw std::invalid_argument("MatrixMultiplier: operand shape does not match M x K * K x N");
+        }
+        Matrix<Acc> C(M, N);
+        csrTimesDense(A, B.view(), C.view(), *pool);
+        return C;
+    }
+
+    // A (плотная) * B (CSC): M * nnz(B) умножений
+    Matrix<Acc> multiplySparse(const Matrix<T>& A, const CscMatrix<T>& B) {
+        if (A.rows() != M || A.cols() != K || B.rows != K || B.cols != N) {
+            throw std::invalid_argument("MatrixMultiplier: operand shape does not match M x K * K x N");
+        }
+        Matrix<Acc> C(M, N);
+        denseTimesCsc(A.view(), B, C.view(), *pool);
+        return C;
+    }
+
+    // A (CSR) * B (CSR) по Густавсону, результат тоже в CSR
+    CsrMatrix<Acc> multiplySparse(const CsrMatrix<T>& A, const CsrMatrix<T>& B) {
+        if (A.rows != M || A.cols != K || B.rows != K || B.cols != N) {
+            throw std::invalid_argument("MatrixMultiplier: operand shape does not match M x K * K x N");
+        }
+        return csrTimesCsr<T, Acc>(A, B, *pool);
+    }
+
+    // Выбор между плотным и разреженным умножением по доле ненулевых
+    // (пороги kSparseRowsDensity/kSparseColsDensity). Плотный путь — настроенная конфигурация, если autoTune() уже выполнялась,
+    // иначе блочное умножение.
+    Matrix<Acc> multiplyAuto(const Matrix<T>& A, const Matrix<T>& B) {
+        checkOperands(A, B);
+        const double cells = static_cast<double>(M) * K;
+        if (cells > 0 && countNonZeros(A, *pool) <= kSparseRowsDensity * cells) {
+            autoPath = "csr x dense";
+            return multiplySparse(toCsr(A), B);
+        }
+        if (cells > 0 && countNonZeros(B, *pool) <= kSparseColsDensity * K * static_cast<double>(N)) {
+            autoPath = "dense x csc";
+            return multiplySparse(A, toCsc(B));
+        }
+        autoPath = "dense";
+        return tunedReady ? runTuned(tuned, A, B) : multiplyBlocked(A, B);
+    }
+
+    // Путь, выбранный последним multiplyAuto: "dense", "csr x dense" или "dense x csc"
+    const char* lastAutoPath() const { return autoPath; }
+
+    // Пакет независимых произведений C[b] = A[b] * B[b], каждое M x K * K x N.
+    // Параллелизм — по пакету: задача пула считает подряд несколько целых произведений
+    // (не меньше ~64K операций), каждое — одним ядром без блокирования и упаковки.
+    // Для квадратных 8, 16, 32 и 64 размер ядра задан при компиляции.
+    MatrixBatch<Acc> multiplyBatch(const MatrixBatch<T>& A, const MatrixBatch<T>& B) {
+        if (A.size() != B.size() || A.rows() != M || A.cols() != K || B.rows() != K || B.cols() != N) {
+            throw std::invalid_argument("MatrixMultiplier: batch shape does not match M x K * K x N");
+        }
+        MatrixBatch<Acc> C(A.size(), M, N);
+        const SmallKernel<T, Acc> small = selectSmallKernel<T, Acc>(M, K, N);
+        const double flops = 2.0 * M * K * std::max(N, 1);
+        const int perTask = std::max(1, static_cast<int>(65536 / std::max(flops, 1.0)));
+        const int tasks = (A.size() + perTask - 1) / perTask;
+
+        pool->parallelFor(tasks, [&](int task) {
+            const int end = std::min(A.size(), (task + 1) * perTask);
+            for (int b = task * perTask; b < end; b++) {
+                small(M, K, N, A.data(b), B.data(b), C.data(b));
+            }
+        });
+        return C;
+    }
+
+    // Пары операндов отдельными матрицами: упаковываются в непрерывные пакеты
+    std::vector<Matrix<Acc>> multiplyBatch(const std::vector<Matrix<T>>& A, const std::vector<Matrix<T>>& B) {
+        if (A.size() != B.size()) {
+            throw std::invalid_argument("MatrixMultiplier: batch operands differ in count");
+        }
+        if (A.empty()) {
+            return std::vector<Matrix<Acc>>();
+        }
+        MatrixBatch<Acc> C = multiplyBatch(MatrixBatch<T>::fromMatrices(A), MatrixBatch<T>::fromMatrices(B));
+        std::vector<Matrix<Acc>> result;
+        result.reserve(C.size());
+        for (int b = 0; b < C.size(); b++) {
+            result.push_back(C.toMatrix(b));
+        }
+        return result;
+    }
+
+    // Многопоточное умножение с кражей работы: плитки рекурсивно делятся до зерна
+    // grain x grain, простаивающие рабочие крадут отложенные половины у занятых.
+    // grain <= 0 — зерно 32 строки x 64 столбца (кратно кэш-линии C).
+    Matrix<Acc> multiplyParallelWorkStealing(const Matrix<T>& A, const Matrix<T>& B, int grain = 0) {
+        checkOperands(A, B);
+        Matrix<Acc> C(M, N);
+        if (!stealer || stealer->size() != threadCount()) {
+            stealer.reset(new WorkStealingScheduler(threadCount()));
+        }
+        MatrixView<const T> a = A.view();
+        MatrixView<const T> b = B.view();
+        MatrixView<Acc> c = C.view();
+
+        lastStealing = stealer->run(M, N, grain > 0 ? grain : 32, grain > 0 ? grain : 64,
+            [&](const StealTile& tile) {
+                TileRange range = { tile.startRow, tile.endRow, tile.startCol, tile.endCol, 0, K, 0 };
+                multiplyTile(a, b, c, range, GemmOutput::Overwrite);
+            });
+        return C;
+    }
+
+    const StealingStats& stealingStats() const { return lastStealing; }
+
+    // Произведение цепочки factors[0] * factors[1] * ... в порядке с наименьшим числом
+    // операций (planChain); размеры соседних множителей должны быть согласованы,
+    // форма умножителя (M, K, N) не используется. Независимые подцепочки считаются
+    // одновременно на пуле, промежуточные результаты берутся из буферов умножителя и
+    // возвращаются туда, как только их использовало следующее произведение.
+    // При T != Acc множители сначала расширяются до Acc, как в multiplyStrassen.
+    Matrix<Acc> multiplyChain(const std::vector<Matrix<T>>& factors) {
+        if (factors.empty()) {
+            throw std::invalid_argument("MatrixMultiplier: empty chain");
+        }
+        std::vector<int> dims(1, factors[0].rows());
+        for (size_t f = 0; f < factors.size(); f++) {
+            if (factors[f].rows() != dims.back()) {
+                throw std::invalid_argument("MatrixMultiplier: chain factor " + std::to_string(f + 1)
+                    + " does not match the columns of the previous factor");
+            }
+            dims.push_back(factors[f].cols());
+        }
+        lastChain = planChain(dims);
+
+        std::vector<MatrixView<const Acc>> views;
+        if constexpr (std::is_same<T, Acc>::value) {
+            for (const Matrix<T>& factor : factors) {
+                views.push_back(factor.view());
+            }
+            return ChainEvaluator<Packed, Acc>(lastChain, views, *kernel, blocking, *pool, chainBuffers).run();
+        } else {
+            std::vector<Matrix<Acc>> wide;
+            for (const Matrix<T>& factor : factors) {
+                wide.push_back(widen(factor));
+                views.push_back(wide.back().view());
+            }
+            typedef typename KernelSet<Acc, Acc>::Packed WidePacked;
+            const auto& wideKernel = bestKernel<Acc, Acc>();
+            BlockingParams wideBlocking = BlockingParams::forKernel(wideKernel.mr, wideKernel.nr, sizeof(WidePacked));
+            return ChainEvaluator<WidePacked, Acc>(lastChain, views, wideKernel, wideBlocking, *pool,
+                chainBuffers).run();
+        }
+    }
+
+    // План последнего multiplyChain: порядок, число операций против порядка слева направо
+    const ChainPlan& chainPlan() const { return lastChain; }
+    // Сколько буферов промежуточных произведений выделено за всё время
+    long long chainAllocations() const { return chainBuffers.allocations(); }
+
+    // A^k двоичным возведением: O(log k) умножений вместо k - 1 (matrixPower).
+    // Умножитель и A квадратные (M = K = N). Произведения считаются плитками на пуле,
+    // основание, результат и приёмник произведения — буферы умножителя, которые
+    // меняются ролями; при T != Acc A приводится к Acc при копировании в основание.
+    // Целые переполняются по модулю 2^w, как и в остальных умножениях; для точного
+    // ответа по модулю — powerMod.
+    Matrix<Acc> power(const Matrix<T>& A, uint64_t k) {
+        checkSquare(A);
+        if constexpr (std::is_same<T, Acc>::value) {
+            return matrixPower(*kernel, blocking, *pool, A.view(), k, powerBuffers, 0, lastPowerProducts);
+        } else {
+            const auto& wideKernel = bestKernel<Acc, Acc>();
+            BlockingParams wideBlocking = BlockingParams::forKernel(wideKernel.mr, wideKernel.nr,
+                sizeof(typename KernelSet<Acc, Acc>::Packed));
+            return matrixPower(wideKernel, wideBlocking, *pool, A.view(), k, powerBuffers, 0, lastPowerProducts);
+        }
+    }
+
+    // A^k по модулю modulus (1 <= modulus <= 2^31) для целых T: элементы результата
+    // в [0, modulus), отрицательные элементы A приводятся туда же. Внутри считается
+    // в int64_t с приведением после каждой части K, которая не может переполниться.
+    Matrix<Acc> powerMod(const Matrix<T>& A, uint64_t k, int64_t modulus) {
+        static_assert(std::is_integral<T>::value, "powerMod: integral element types only");
+        checkSquare(A);
+        checkPowerModulus(modulus);
+        const auto& wideKernel = bestKernel<int64_t, int64_t>();
+        BlockingParams wideBlocking = BlockingParams::forKernel(wideKernel.mr, wideKernel.nr,
+            sizeof(typename KernelSet<int64_t, int64_t>::Packed));
+        Matrix<int64_t> result = matrixPower(wideKernel, wideBlocking, *pool, A.view(), k, powerModBuffers,
+            modulus, lastPowerProducts);
+        if constexpr (std::is_same<Acc, int64_t>::value) {
+            return result;
+        } else {
+            Matrix<Acc> narrow = Matrix<Acc>::uninitialized(M, M);
+            for (int i = 0; i < M; i++) {
+                for (int j = 0; j < M; j++) {
+                    narrow(i, j) = static_cast<Acc>(result(i, j));
+                }
+            }
+            return narrow;
+        }
+    }
+
+    // Умножений в последнем power/powerMod
+    int powerProducts() const { return lastPowerProducts; }
+
+    // Адаптеры для старого представления vector<vector<T>>
+    std::vector<std::vector<Acc>> multiplySequential(
+        const std::vector<std::vector<T>>& A,
+        const std::vector<std::vector<T>>& B) {
+        return multiplySequential(Matrix<T>::fromNested(A), Matrix<T>::fromNested(B)).toNested();
+    }
+
+    std::vector<std::vector<Acc>> multiplyParallelPthread(
+        const std::vector<std::vector<T>>& A,
+        const std::vector<std::vector<T>>& B,
+        int blockSize) {
+        return multiplyParallelPthread(Matrix<T>::fromNested(A), Matrix<T>::fromNested(B),
+            blockSize).toNested();
+    }
+
+    std::vector<std::vector<Acc>> multiplyParallelStdThread(
+        const std::vector<std::vector<T>>& A,
+        const std::vector<std::vector<T>>& B,
+        int blockSize) {
+        return multiplyParallelStdThread(Matrix<T>::fromNested(A), Matrix<T>::fromNested(B),
+            blockSize).toNested();
+    }
+
+    std::vector<std::vector<Acc>> multiplyParallelWorkStealing(
+        const std::vector<std::vector<T>>& A,
+        const std::vector<std::vector<T>>& B,
+        int grain = 0) {
+        return multiplyParallelWorkStealing(Matrix<T>::fromNested(A), Matrix<T>::fromNested(B),
+            grain).toNested();
+    }
+
+    std::vector<std::vector<Acc>> multiplyBlocked(
+        const std::vector<std::vector<T>>& A,
+        const std::vector<std::vector<T>>& B) {
+        return multiplyBlocked(Matrix<T>::fromNested(A), Matrix<T>::fromNested(B)).toNested();
+    }
+
+    std::vector<std::vector<Acc>> multiplyStrassen(
+        const std::vector<std::vector<T>>& A,
+        const std::vector<std::vector<T>>& B,
+        int cutoff = 512) {
+        return multiplyStrassen(Matrix<T>::fromNested(A), Matrix<T>::fromNested(B), cutoff).toNested();
+    }
+
+    std::vector<std::vector<Acc>> multiplyParallelPool(
+        const std::vector<std::vector<T>>& A,
+        const std::vector<std::vector<T>>& B,
+        int blockSize) {
+        return multiplyParallelPool(Matrix<T>::fromNested(A), Matrix<T>::fromNested(B),
+            blockSize).toNested();
+    }
+
+    // Проверка равенства матриц
+    template<class U>
+    bool areMatricesEqual(const Matrix<U>& A, const Matrix<U>& B) {
+        if (A.rows() != B.rows() || A.cols() != B.cols()) {
+            return false;
+        }
+        for (int i = 0; i < A.rows(); i++) {
+            const U* a = A.row(i);
+            const U* b = B.row(i);
+            for (int j = 0; j < A.cols(); j++) {
+                if (a[j] != b[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool areMatricesEqual(const std::vector<std::vector<T>>& A,
+        const std::vector<std::vector<T>>& B) {
+        if (A.size() != B.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < A.size(); i++) {
+            if (A[i].size() != B[i].size()) {
+                return false;
+            }
+            for (size_t j = 0; j < A[i].size(); j++) {
+                if (A[i][j] != B[i][j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Сравнение с допуском для вещественных типов: |a - b| <= relTol * max(|a|, |b|) + absTol.
+    // По умолчанию relTol растёт с длиной скалярного произведения K, так как каждое
+    // сложение может внести ошибку округления порядка машинного эпсилон.
+    template<class U>
+    bool areMatricesClose(const Matrix<U>& A, const Matrix<U>& B,
+        double relTol = -1.0, double absTol = 0.0) const {
+        if (A.rows() != B.rows() || A.cols() != B.cols()) {
+            return false;
+        }
+        if (relTol < 0.0) {
+            relTol = 4.0 * std::max(K, 1) * std::numeric_limits<U>::epsilon();
+        }
+        for (int i = 0; i < A.rows(); i++) {
+            const U* a = A.row(i);
+            const U* b = B.row(i);
+            for (int j = 0; j < A.cols(); j++) {
+                double x = static_cast<double>(a[j]);
+                double y = static_cast<double>(b[j]);
+                double scale = std::max(std::fabs(x), std::fabs(y));
+                if (std::fabs(x - y) > relTol * scale + absTol) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Проверка результата: точное совпадение для целых, с допуском — для вещественных
+    bool matchesReference(const Matrix<Acc>& reference, const Matrix<Acc>& result) {
+        if constexpr (std::is_floating_point<Acc>::value) {
+            return areMatricesClose(reference, result);
+        } else {
+            return areMatricesEqual(reference, result);
+        }
+    }
+
+    // Параллельная проверка результата по эталону: точная для целых, с допуском
+    // areMatricesClose — для вещественных
+    bool matchesReferenceParallel(const Matrix<Acc>& reference, const Matrix<Acc>& result) {
+        double relTol = 0.0;
+        if constexpr (std::is_floating_point<Acc>::value) {
+            relTol = 4.0 * std::max(K, 1) * std::numeric_limits<Acc>::epsilon();
+        }
+        return matricesMatchParallel(reference.view(), result.view(), *pool, relTol);
+    }
+
+    // Проверка C == A * B по Фрейвалдсу за O(t * (M*K + K*N + M*N)), t = log2(1/p) испытаний.
+    // Ошибочный C принимается с вероятностью не выше falseAcceptProbability.
+    // Без seed векторы берутся из random_device, чтобы их нельзя было предсказать.
+    bool verifyFreivalds(const Matrix<T>& A, const Matrix<T>& B, const Matrix<Acc>& C,
+        double falseAcceptProbability = 1e-9) {
+        std::random_device rd;
+        return verifyFreivalds(A, B, C, falseAcceptProbability,
+            (static_cast<uint64_t>(rd()) << 32) | rd());
+    }
+
+    bool verifyFreivalds(const Matrix<T>& A, const Matrix<T>& B, const Matrix<Acc>& C,
+        double falseAcceptProbability, uint64_t seed) {
+        checkOperands(A, B);
+        if (C.rows() != M || C.cols() != N) {
+            throw std::invalid_argument("MatrixMultiplier: result shape does not match M x N");
+        }
+        return freivaldsCheck<T, Acc>(A.view(), B.view(), C.view(), falseAcceptProbability, *pool, seed);
+    }
+
+    // Заполнение матрицы случайными значениями: целые 0..9 или вещественные из [0, 9)
+    void fillMatrixRandom(Matrix<T>& matrix) {
+        std::random_device rd;
+        fillMatrixRandom(matrix, (static_cast<uint64_t>(rd()) << 32) | rd());
+    }
+
+    // Воспроизводимое заполнение генератором со счётчиком, параллельно на пуле:
+    // одно и то же seed даёт побитово ту же матрицу при любом числе потоков
+    void fillMatrixRandom(Matrix<T>& matrix, uint64_t seed) {
+        fillUniform(matrix.view(), seed, T(0), T(9), *pool);
+    }
+
+    // Заполнение файла матрицы по плиткам, не держа её в памяти целиком.
+    // Номера элементов глобальные, поэтому файл совпадает с матрицей в памяти
+    // с тем же seed.
+    void fillMatrixRandom(MappedMatrix<T>& matrix, uint64_t seed) {
+        for (int tr = 0; tr < matrix.gridRows(); tr++) {
+            for (int tc = 0; tc < matrix.gridCols(); tc++) {
+                fillUniform(matrix.tile(tr, tc), seed, T(0), T(9), *pool,
+                    static_cast<int64_t>(tr) * matrix.tileRows(), static_cast<int64_t>(tc) * matrix.tileCols(),
+                    matrix.cols());
+                matrix.releaseTile(tr, tc);
+            }
+        }
+    }
+
+    void fillMatrixRandom(std::vector<std::vector<T>>& matrix) {
+        std::random_device rd;
+        const uint64_t seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+        for (size_t i = 0; i < matrix.size(); i++) {
+            fillUniformRow(matrix[i].data(), static_cast<int>(matrix[i].size()), seed,
+                static_cast<uint64_t>(i) * matrix[i].size(), T(0), T(9));
+        }
+    }
+
+    // Тестирование для одного размера блока (blockSize <= 0 — разбиение под форму)
+    void testBlockSize(int blockSize) {
+        // Создаем матрицы
+        Matrix<T> A(M, K);
+        Matrix<T> B(K, N);
+
+        // Заполняем случайными значениями
+        fillMatrixRandom(A);
+        fillMatrixRandom(B);
+
+        // Вычисляем количество блоков и потоков
+        Partition partition = makePartition(blockSize);
+        int totalBlocks = partition.tiles();
+
+        std::cout << "Матрица: " << M << "x" << K << " * " << K << "x" << N;
+        std::cout << " (" << elementTypeName<T>() << " -> " << elementTypeName<Acc>() << ")";
+        if (blockSize > 0) {
+            std::cout << ", Блок: " << blockSize;
+        } else {
+            std::cout << ", Блок (авто): " << partition.rowBlock << "x" << partition.colBlock;
+            if (partition.kParts > 1) {
+                std::cout << ", частей по K: " << partition.kParts;
+            }
+        }
+        std::cout << ", Блоков: " << totalBlocks;
+        std::cout << ", Потоков std::thread/pthread: " << totalBlocks;
+        std::cout << ", Потоков пула: " << threadCount() << std::endl;
+
+        // Тестируем последовательное умножение. При проверке Фрейвалдса эталон не нужен:
+        // последовательное умножение пропускается, ускорения считаются от блочного
+        const bool needReference = verification != VerifyMode::Freivalds;
+        Matrix<Acc> C_seq;
+        std::chrono::microseconds seq_time(0);
+        auto start = std::chrono::high_resolution_clock::now();
+        auto end = start;
+        if (needReference) {
+            C_seq = multiplySequential(A, B);
+            end = std::chrono::high_resolution_clock::now();
+            seq_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        }
+
+        // Тестируем последовательное блочное умножение (со счётчиками perf, если доступны)
+        PerfCounters counters;
+        counters.start();
+        start = std::chrono::high_resolution_clock::now();
+        auto C_blocked = multiplyBlocked(A, B);
+        end = std::chrono::high_resolution_clock::now();
+        PerfSample blocked_counters = counters.stop();
+        auto blocked_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        // Тестируем умножение Штрассена–Винограда: порог ниже размеров теста,
+        // чтобы работали рекурсия, отщепление нечётных краёв и параллельный верхний уровень
+        start = std::chrono::high_resolution_clock::now();
+        auto C_strassen = multiplyStrassen(A, B, 64);
+        end = std::chrono::high_resolution_clock::now();
+        auto strassen_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        // Тестируем параллельное умножение (std::thread)
+        start = std::chrono::high_resolution_clock::now();
+        auto C_par_std = multiplyParallelStdThread(A, B, blockSize);
+        end = std::chrono::high_resolution_clock::now();
+        auto par_std_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        // Тестируем параллельное умножение (pthread)
+        start = std::chrono::high_resolution_clock::now();
+        auto C_par_pthread = multiplyParallelPthread(A, B, blockSize);
+        end = std::chrono::high_resolution_clock::now();
+        auto par_pthread_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        // Тестируем pthread с привязкой к ядрам и размещением по узлам NUMA
+        bool wasPinned = pinThreads;
+        setPinThreads(true);
+        start = std::chrono::high_resolution_clock::now();
+        auto C_par_pinned = multiplyParallelPthread(A, B, blockSize);
+        end = std::chrono::high_resolution_clock::now();
+        auto par_pinned_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        setPinThreads(wasPinned);
+
+        // Тестируем параллельное умножение (пул потоков)
+        counters.start();
+        start = std::chrono::high_resolution_clock::now();
+        auto C_par_pool = multiplyParallelPool(A, B, blockSize);
+        end = std::chrono::high_resolution_clock::now();
+        PerfSample pool_counters = counters.stop();
+        auto par_pool_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        // Тестируем параллельное умножение с кражей работы (зерно = размер блока)
+        start = std::chrono::high_resolution_clock::now();
+        auto C_par_steal = multiplyParallelWorkStealing(A, B, blockSize);
+        end = std::chrono::high_resolution_clock::now();
+        auto par_steal_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        // Проверяем корректность выбранным способом
+        auto verify = [&](const Matrix<Acc>& C) {
+            switch (verification) {
+            case VerifyMode::Exact:
+                return matchesReferenceParallel(C_seq, C);
+            case VerifyMode::Freivalds:
+                return verifyFreivalds(A, B, C, falseAccept);
+            default:
+                return matchesReference(C_seq, C);
+            }
+        };
+        start = std::chrono::high_resolution_clock::now();
+        bool correct_std = verify(C_par_std);
+        bool correct_pthread = verify(C_par_pthread);
+        bool correct_pinned = verify(C_par_pinned);
+        bool correct_pool = verify(C_par_pool);
+        bool correct_steal = verify(C_par_steal);
+        bool correct_blocked = verify(C_blocked);
+        bool correct_strassen = verify(C_strassen);
+        end = std::chrono::high_resolution_clock::now();
+        auto verify_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        const long long base_time = needReference ? seq_time.count() : blocked_time.count();
+
+        double speedup_std = 0.0;
+        double speedup_pthread = 0.0;
+        double speedup_pinned = 0.0;
+        double speedup_pool = 0.0;
+        double speedup_steal = 0.0;
+        double speedup_blocked = 0.0;
+        double speedup_strassen = 0.0;
+        
+        if (par_std_time.count() > 0) {
+            speedup_std = static_cast<double>(base_time) / par_std_time.count();
+        }
+        if (par_pthread_time.count() > 0) {
+            speedup_pthread = static_cast<double>(base_time) / par_pthread_time.count();
+        }
+        if (par_pinned_time.count() > 0) {
+            speedup_pinned = static_cast<double>(base_time) / par_pinned_time.count();
+        }
+        if (blocked_time.count() > 0) {
+            speedup_blocked = static_cast<double>(base_time) / blocked_time.count();
+        }
+        if (strassen_time.count() > 0) {
+            speedup_strassen = static_cast<double>(base_time) / strassen_time.count();
+        }
+        if (par_pool_time.count() > 0) {
+            speedup_pool = static_cast<double>(base_time) / par_pool_time.count();
+        }
+        if (par_steal_time.count() > 0) {
+            speedup_steal = static_cast<double>(base_time) / par_steal_time.count();
+        }
+
+        if (needReference) {
+            std::cout << "Последовательное: " << seq_time.count() << " мкс" << std::endl;
+        } else {
+            std::cout << "Последовательное: пропущено (ускорения от блочного)" << std::endl;
+        }
+        std::cout << "Последовательное блочное (" << kernel->name << "): " << blocked_time.count() << " мкс";
+        std::cout << " (ускорение: " << std::fixed << std::setprecision(2) << speedup_blocked << "x)" << std::endl;
+        printCounters(counters, blocked_counters);
+        std::cout << "Штрассен–Виноград: " << strassen_time.count() << " мкс";
+        std::cout << " (ускорение: " << std::fixed << std::setprecision(2) << speedup_strassen << "x)" << std::endl;
+        std::cout << "Параллельное (std::thread): " << par_std_time.count() << " мкс";
+        std::cout << " (ускорение: " << std::fixed << std::setprecision(2) << speedup_std << "x)" << std::endl;
+        std::cout << "Параллельное (pthread): " << par_pthread_time.count() << " мкс";
+        std::cout << " (ускорение: " << std::fixed << std::setprecision(2) << speedup_pthread << "x)" << std::endl;
+        std::cout << "Параллельное (pthread, привязка к ядрам): " << par_pinned_time.count() << " мкс";
+        std::cout << " (ускорение: " << std::fixed << std::setprecision(2) << speedup_pinned << "x)" << std::endl;
+        std::cout << "  узлов NUMA: " << NumaTopology::detect().nodes();
+        std::cout << ", страниц локально: " << lastPlacement.local << ", удалённо: " << lastPlacement.remote;
+        if (lastPlacement.unknown > 0) {
+            std::cout << ", не определено: " << lastPlacement.unknown;
+        }
+        std::cout << std::endl;
+        std::cout << "Параллельное (пул потоков): " << par_pool_time.count() << " мкс";
+        std::cout << " (ускорение: " << std::fixed << std::setprecision(2) << speedup_pool << "x)" << std::endl;
+        printCounters(counters, pool_counters);
+        std::cout << "Параллельное (кража работы): " << par_steal_time.count() << " мкс";
+        std::cout << " (ускорение: " << std::fixed << std::setprecision(2) << speedup_steal << "x)" << std::endl;
+        // Хвост: сколько первый освободившийся рабочий ждал последнего
+        std::cout << "  хвост: " << std::setprecision(1) << lastStealing.tailUs() << " мкс";
+        std::cout << ", краж: " << lastStealing.steals() << ", плиток по рабочим:";
+        for (const WorkerStats& w : lastStealing.workers) {
+            std::cout << " " << w.tiles;
+        }
+        std::cout << std::endl;
+        std::cout << "Корректность std::thread: " << (correct_std ? "Да" : "НЕТ!") << std::endl;
+        std::cout << "Корректность pthread: " << (correct_pthread ? "Да" : "НЕТ!") << std::endl;
+        std::cout << "Корректность pthread с привязкой: " << (correct_pinned ? "Да" : "НЕТ!") << std::endl;
+        std::cout << "Корректность пула: " << (correct_pool ? "Да" : "НЕТ!") << std::endl;
+        std::cout << "Корректность кражи работы: " << (correct_steal ? "Да" : "НЕТ!") << std::endl;
+        std::cout << "Корректность блочного: " << (correct_blocked ? "Да" : "НЕТ!") << std::endl;
+        std::cout << "Корректность Штрассена: " << (correct_strassen ? "Да" : "НЕТ!") << std::endl;
+        std::cout << "Проверка (";
+        if (verification == VerifyMode::Freivalds) {
+            std::cout << "Фрейвалдс, испытаний: " << freivaldsTrials(falseAccept)
+                      << ", ложное принятие <= " << std::scientific << std::setprecision(0) << falseAccept
+                      << std::fixed;
+        } else {
+            std::cout << (verification == VerifyMode::Exact ? "параллельное сравнение" : "сравнение с эталоном");
+        }
+        std::cout << "): " << verify_time.count() << " мкс на 7 результатов" << std::endl;
+        std::cout << "----------------------------------------" << std::endl;
+    }
+};
+
+typedef BasicMatrixMultiplier<int> MatrixMultiplier;
+
+#endif // MATRIX_MULTIPLIER_H_
@@ -0,0 +1,192 @@
+#ifndef NUMA_H_
+#define NUMA_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "matrix.h"
+
+// Список CPU в формате sysfs: "0-3,8,10-11"
+inline std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty() || item == "\n") {
+            continue;
+        }
+        int first = 0;
+        int last = 0;
+        char dash = 0;
+        std::stringstream range(item);
+        range >> first;
+        if (range >> dash >> last && dash == '-') {
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } else {
+            cpus.push_back(first);
+        }
+    }
+    return cpus;
+}
+
+// Узлы NUMA по /sys/devices/system/node и CPU каждого узла, доступные процессу.
+// Без sysfs (или без NUMA в ядре) — один узел со всеми доступными CPU.
+struct NumaTopology {
+    std::vector<int> nodeIds;               // номера узлов в sysfs
+    std::vector<std::vector<int>> nodeCpus; // доступные CPU узла; узлы без CPU пропущены
+
+    int nodes() const { return static_cast<int>(nodeIds.size()); }
+    bool multiNode() const { return nodes() > 1; }
+
+    static const NumaTopology& detect() {
+        static const NumaTopology topology = query();
+        return topology;
+    }
+
+private:
+    static std::string readFile(const std::string& path) {
+        std::ifstream file(path);
+        std::string text;
+        std::getline(file, text);
+        return text;
+    }
+
+    static NumaTopology query() {
+        std::vector<int> allowed;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set)) {
+                    allowed.push_back(cpu);
+                }
+            }
+        }
+        if (allowed.empty()) {
+            int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            for (int cpu = 0; cpu < count; cpu++) {
+                allowed.push_back(cpu);
+            }
+        }
+
+        NumaTopology topology;
+        const std::string root = "/sys/devices/system/node/";
+        for (int node : parseCpuList(readFile(root + "online"))) {
+            std::vector<int> cpus;
+            for (int cpu : parseCpuList(readFile(root + "node" + std::to_string(node) + "/cpulist"))) {
+                if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+                    cpus.push_back(cpu);
+                }
+            }
+            if (!cpus.empty()) {
+                topology.nodeIds.push_back(node);
+                topology.nodeCpus.push_back(cpus);
+            }
+        }
+        if (topology.nodeIds.empty()) {
+            topology.nodeIds.push_back(0);
+            topology.nodeCpus.push_back(allowed);
+        }
+        return topology;
+    }
+};
+
+// Строки [numaBandStart(n), numaBandStart(n + 1)) матрицы из rows строк принадлежат узлу n
+inline int numaBandStart(int rows, int nodes, int node) {
+    return static_cast<int>(static_cast<long long>(rows) * node / nodes);
+}
+
+inline int numaNodeForRow(int row, int rows, int nodes) {
+    int node = nodes - 1;
+    while (node > 0 && numaBandStart(rows, nodes, node) > row) {
+        node--;
+    }
+    return node;
+}
+
+// Запуск потока, привязанного к набору CPU. Если привязка не удалась
+// (CPU недоступен, нет поддержки), поток запускается без неё.
+inline bool startPinnedThread(pthread_t* thread, const std::vector<int>& cpus,
+    void* (*fn)(void*), void* arg) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    pthread_attr_t attr;
+    bool pinned = false;
+    if (pthread_attr_init(&attr) == 0) {
+        pinned = pthread_attr_setaffinity_np(&attr, sizeof(set), &set) == 0
+            && pthread_create(thread, &attr, fn, arg) == 0;
+        pthread_attr_destroy(&attr);
+    }
+    return pinned || pthread_create(thread, nullptr, fn, arg) == 0;
+}
+
+// Размещение страниц: на узле своих строк, на чужом, не определено
+// (страница не выделена или move_pages недоступен)
+struct NumaPlacement {
+    long long local;
+    long long remote;
+    long long unknown;
+
+    NumaPlacement& operator+=(const NumaPlacement& other) {
+        local += other.local;
+        remote += other.remote;
+        unknown += other.unknown;
+        return *this;
+    }
+};
+
+// Сравнивает узел каждой страницы матрицы (move_pages без перемещения) с узлом,
+// которому по numaBandStart принадлежит первая строка страницы
+template<class T>
+NumaPlacement numaRowPlacement(MatrixView<const T> matrix, const NumaTopology& topology) {
+    NumaPlacement placement = {};
+    if (matrix.empty()) {
+        return placement;
+    }
+    const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const size_t rowBytes = static_cast<size_t>(matrix.stride()) * sizeof(T);
+    const uintptr_t base = reinterpret_cast<uintptr_t>(matrix.data());
+    const uintptr_t end = base + rowBytes * matrix.rows();
+
+    const size_t batch = 1024;
+    std::vector<void*> pages;
+    std::vector<int> expected;
+    std::vector<int> status(batch);
+    for (uintptr_t page = base & ~(pageSize - 1); page < end; page += pageSize) {
+        int row = page > base ? static_cast<int>((page - base) / rowBytes) : 0;
+        pages.push_back(reinterpret_cast<void*>(page));
+        expected.push_back(topology.nodeIds[numaNodeForRow(row, matrix.rows(), topology.nodes())]);
+        if (pages.size() < batch && page + pageSize < end) {
+            continue;
+        }
+        long rc = syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0);
+        for (size_t i = 0; i < pages.size(); i++) {
+            if (rc != 0 || status[i] < 0) {
+                placement.unknown++;
+            } else if (status[i] == expected[i]) {
+                placement.local++;
+            } else {
+                placement.remote++;
+            }
+        }
+        pages.clear();
+        expected.clear();
+    }
+    return placement;
+}
+
+#endif // NUMA_H_
@@ -0,0 +1,149 @@
+#ifndef PARTITION_H_
+#define PARTITION_H_
+
+#include <algorithm>
+
+// Диапазоны одной плитки разбиения C (M x N) и внутреннего измерения K
+struct TileRange {
+    int startRow;
+    int endRow;
+    int startCol;
+    int endCol;
+    int startK;
+    int endK;
+    int kPart; // номер части по K: 0 пишет прямо в C, остальные — в частичные суммы
+};
+
+// Разбиение произведения (M x K) * (K x N) на плитки gridRows x gridCols x kParts.
+// При kParts > 1 плитки с kPart > 0 накапливают частичные суммы, которые затем
+// складываются в C.
+struct Partition {
+    int M;
+    int N;
+    int K;
+    int rowBlock;
+    int colBlock;
+    int kBlock;
+    int gridRows;
+    int gridCols;
+    int kParts;
+
+    int tiles() const { return gridRows * gridCols * kParts; }
+
+    TileRange tile(int index) const {
+        TileRange t;
+        int outputTiles = gridRows * gridCols;
+        t.kPart = index / outputTiles;
+        index %= outputTiles;
+        t.startRow = (index / gridCols) * rowBlock;
+        t.endRow = std::min(t.startRow + rowBlock, M);
+        t.startCol = (index % gridCols) * colBlock;
+        t.endCol = std::min(t.startCol + colBlock, N);
+        t.startK = t.kPart * kBlock;
+        t.endK = std::min(t.startK + kBlock, K);
+        return t;
+    }
+
+    // Фиксированные квадратные блоки blockSize x blockSize по всей глубине K
+    static Partition fixed(int M, int N, int K, int blockSize) {
+        blockSize = std::max(blockSize, 1);
+        return make(M, N, K, blockSize, blockSize, 1);
+    }
+
+    // Блоки blockSize строк, ширина округлена вверх до целых кэш-линий C
+    // (lineElements элементов). Строки C начинаются с границы линии, поэтому
+    // никакие две плитки не пишут в одну линию.
+    static Partition lineAligned(int M, int N, int K, int blockSize, int lineElements) {
+        blockSize = std::max(blockSize, 1);
+        lineElements = std::max(lineElements, 1);
+        int colBlock = (blockSize + lineElements - 1) / lineElements * lineElements;
+        return make(M, N, K, blockSize, colBlock, 1);
+    }
+
+    // Кэш-линии C (и буферов частичных сумм), в которые пишут несколько плиток одной
+    // части K, при lineElements элементах в линии и строках, выровненных по линии.
+    // Каждая такая линия при параллельном счёте ходит между ядрами (ложное разделение).
+    long long sharedLines(int lineElements) const {
+        lineElements = std::max(lineElements, 1);
+        long long perRow = 0;
+        for (int start = 0; start < N; start += lineElements) {
+            const int end = std::min(start + lineElements, N);
+            if ((end - 1) / colBlock != start / colBlock) {
+                perRow++;
+            }
+        }
+        return perRow * M * kParts;
+    }
+
+    // Все кэш-линии C и буферов частичных сумм
+    long long outputLines(int lineElements) const {
+        lineElements = std::max(lineElements, 1);
+        return static_cast<long long>((N + lineElements - 1) / lineElements) * M * kParts;
+    }
+
+    // Разбиение под форму задачи: не меньше parts плиток с минимальным периметром,
+    // т.е. с наименьшим объёмом A и B, который читает каждая плитка.
+    // Высокие и узкие произведения режутся по строкам, короткие и широкие — по столбцам;
+    // если M x N слишком мало для parts плиток, дополнительно режется K
+    // (кроме splitK = false: тогда плитки пишут прямо в C без частичных сумм).
+    static Partition forShape(int M, int N, int K, int parts, bool splitK = true) {
+        parts = std::max(parts, 1);
+        if (M <= 0 || N <= 0) {
+            return make(M, N, K, 1, 1, 1);
+        }
+
+        // Минимальная плитка: одна строка и одна кэш-линия столбцов, чтобы соседние
+        // потоки не писали в одну и ту же линию C
+        const int minCols = std::min(N, 16);
+        const int maxGridCols = (N + minCols - 1) / minCols;
+
+        int bestRows = 1;
+        int bestCols = 1;
+        double bestCost = -1.0;
+        int bestTiles = 1;
+        for (int gr = 1; gr <= std::min(M, parts); gr++) {
+            int gc = std::min((parts + gr - 1) / gr, maxGridCols);
+            int tiles = gr * gc;
+            double cost = static_cast<double>(M) / gr + static_cast<double>(N) / gc;
+            bool better = bestCost < 0.0
+                || (std::min(tiles, parts) > std::min(bestTiles, parts))
+                || (std::min(tiles, parts) == std::min(bestTiles, parts) && cost < bestCost);
+            if (better) {
+                bestRows = gr;
+                bestCols = gc;
+                bestCost = cost;
+                bestTiles = tiles;
+            }
+        }
+
+        int kParts = 1;
+        if (splitK && bestTiles < parts && K >= 2 * 256) {
+            kParts = std::min((parts + bestTiles - 1) / bestTiles, K / 256);
+        }
+
+        int rowBlock = (M + bestRows - 1) / bestRows;
+        int colBlock = (N + bestCols - 1) / bestCols;
+        // Границы столбцов кратны кэш-линии
+        if (bestCols > 1) {
+            colBlock = (colBlock + minCols - 1) / minCols * minCols;
+        }
+        return make(M, N, K, rowBlock, colBlock, kParts);
+    }
+
+private:
+    static Partition make(int M, int N, int K, int rowBlock, int colBlock, int kParts) {
+        Partition p;
+        p.M = M;
+        p.N = N;
+        p.K = K;
+        p.rowBlock = rowBlock;
+        p.colBlock = colBlock;
+        p.gridRows = M > 0 ? (M + rowBlock - 1) / rowBlock : 0;
+        p.gridCols = N > 0 ? (N + colBlock - 1) / colBlock : 0;
+        p.kBlock = kParts > 1 ? (K + kParts - 1) / kParts : std::max(K, 1);
+        p.kParts = kParts > 1 ? (K + p.kBlock - 1) / p.kBlock : 1;
+        return p;
+    }
+};
+
+#endif // PARTITION_H_
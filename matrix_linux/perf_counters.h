@@ -0,0 +1,271 @@
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+// Аппаратные счётчики через perf_event_open: такты, инструкции, промахи L1d, LLC и dTLB.
+// Считается только пространство пользователя (exclude_kernel), поэтому хватает
+// perf_event_paranoid <= 2. Если счётчик открыть нельзя (нет прав, нет PMU в
+// виртуальной машине, нет системного вызова), он просто отсутствует в замерах.
+enum PerfEvent {
+    kPerfCycles,
+    kPerfInstructions,
+    kPerfL1dMisses,
+    kPerfLlcMisses,
+    kPerfDtlbMisses,
+    kPerfEventCount
+};
+
+inline const char* perfEventName(int event) {
+    static const char* const names[kPerfEventCount] = { "cycles", "instructions", "l1d_misses",
+        "llc_misses", "dtlb_misses" };
+    return names[event];
+}
+
+// Значения счётчиков за один замер (с поправкой на мультиплексирование)
+struct PerfSample {
+    uint64_t value[kPerfEventCount];
+    unsigned mask; // бит event — счётчик был доступен
+
+    PerfSample() : value(), mask(0) {}
+
+    bool has(int event) const { return (mask >> event) & 1; }
+    bool empty() const { return mask == 0; }
+
+    // Инструкций за такт; -1 — нет одного из счётчиков
+    double ipc() const {
+        if (!has(kPerfCycles) || !has(kPerfInstructions) || value[kPerfCycles] == 0) {
+            return -1.0;
+        }
+        return static_cast<double>(value[kPerfInstructions]) / value[kPerfCycles];
+    }
+
+    // Событий на одну операцию (2*M*N*K операций на произведение); -1 — нет счётчика
+    double perFlop(int event, double flops) const {
+        if (!has(event) || flops <= 0.0) {
+            return -1.0;
+        }
+        return static_cast<double>(value[event]) / flops;
+    }
+
+    // Сумма замеров: счётчик есть в сумме, только если он есть в обоих
+    PerfSample& operator+=(const PerfSample& other) {
+        mask = empty() ? other.mask : mask & other.mask;
+        for (int e = 0; e < kPerfEventCount; e++) {
+            value[e] += other.value[e];
+        }
+        return *this;
+    }
+};
+
+// Набор счётчиков одного потока (Thread) или всех потоков процесса (Process).
+// Process открывает счётчики для каждого потока из /proc/self/task (в том числе для
+// уже запущенных рабочих пулов). Потоки, созданные позже, считаются через inherit:
+// ядро заводит им дочерние счётчики, которые входят в значение родительского,
+// поэтому отдельно их открывать нельзя — иначе они посчитаются дважды.
+class PerfCounters {
+public:
+    enum Scope { Thread, Process };
+
+    explicit PerfCounters(Scope scope = Process) : scope_(scope), errno_(0) {
+        if (scope_ == Thread) {
+            openTask(0);
+        } else {
+            openProcess();
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+        for (const Task& task : tasks_) {
+            for (int fd : task.fds) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+        }
+    }
+
+    // Хотя бы один счётчик открыт
+    bool available() const {
+        for (const Task& task : tasks_) {
+            for (int fd : task.fds) {
+                if (fd >= 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Почему счётчики недоступны (по первой ошибке perf_event_open)
+    std::string unavailableReason() const {
+        if (available()) {
+            return std::string();
+        }
+        if (errno_ == EACCES || errno_ == EPERM) {
+            return "no permission (kernel.perf_event_paranoid)";
+        }
+        if (errno_ == ENOENT || errno_ == EOPNOTSUPP) {
+            return "no hardware PMU events";
+        }
+        if (errno_ == ENOSYS) {
+            return "perf_event_open is not supported";
+        }
+        return errno_ ? std::strerror(errno_) : "no counters";
+    }
+
+    // Замер — разность показаний между start() и stop(): PERF_EVENT_IOC_RESET
+    // не обнуляет счета завершившихся дочерних потоков, они копятся в счётчике
+    void start() {
+        for (Task& task : tasks_) {
+            for (int e = 0; e < kPerfEventCount; e++) {
+                if (task.fds[e] >= 0 && !readRaw(task.fds[e], task.base[e])) {
+                    task.base[e][0] = task.base[e][1] = task.base[e][2] = 0;
+                }
+            }
+        }
+        forEachFd([](int fd) { ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); });
+    }
+
+    PerfSample stop() {
+        forEachFd([](int fd) { ioctl(fd, PERF_EVENT_IOC_DISABLE, 0); });
+        PerfSample sample;
+        for (int e = 0; e < kPerfEventCount; e++) {
+            bool any = false;
+            for (const Task& task : tasks_) {
+                uint64_t value = 0;
+                if (readDelta(task.fds[e], task.base[e], value)) {
+                    sample.value[e] += value;
+                    any = true;
+                }
+            }
+            if (any) {
+                sample.mask |= 1u << e;
+            }
+        }
+        return sample;
+    }
+
+private:
+    struct Task {
+        int fds[kPerfEventCount];
+        uint64_t base[kPerfEventCount][3]; // показания при start(): значение, enabled, running
+    };
+
+    static perf_event_attr eventAttr(int event) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        const uint64_t readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        switch (event) {
+        case kPerfCycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case kPerfInstructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case kPerfL1dMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | readMiss;
+            break;
+        case kPerfLlcMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        default:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | readMiss;
+            break;
+        }
+        return attr;
+    }
+
+    // tid 0 — вызывающий поток
+    void openTask(int tid) {
+        Task task = Task();
+        for (int e = 0; e < kPerfEventCount; e++) {
+            perf_event_attr attr = eventAttr(e);
+            task.fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC));
+            if (task.fds[e] < 0 && errno_ == 0) {
+                errno_ = errno;
+            }
+        }
+        tasks_.push_back(task);
+    }
+
+    // Счётчики для всех текущих потоков процесса
+    void openProcess() {
+        DIR* dir = opendir("/proc/self/task");
+        if (!dir) {
+            openTask(0);
+            return;
+        }
+        while (dirent* entry = readdir(dir)) {
+            int tid = std::atoi(entry->d_name);
+            if (tid > 0) {
+                openTask(tid);
+            }
+        }
+        closedir(dir);
+    }
+
+    template<class F>
+    void forEachFd(F fn) {
+        for (const Task& task : tasks_) {
+            for (int fd : task.fds) {
+                if (fd >= 0) {
+                    fn(fd);
+                }
+            }
+        }
+    }
+
+    static bool readRaw(int fd, uint64_t* data) {
+        return read(fd, data, 3 * sizeof(uint64_t)) == static_cast<ssize_t>(3 * sizeof(uint64_t));
+    }
+
+    // Прирост с поправкой на мультиплексирование: value * enabled / running
+    static bool readDelta(int fd, const uint64_t* base, uint64_t& value) {
+        uint64_t data[3];
+        if (fd < 0 || !readRaw(fd, data)) {
+            return false;
+        }
+        for (int i = 0; i < 3; i++) {
+            data[i] -= base[i];
+        }
+        if (data[2] == 0) {
+            value = 0;
+            return data[1] == 0; // не запускался из-за нехватки счётчиков — нет данных
+        }
+        value = data[2] < data[1]
+            ? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2])
+            : data[0];
+        return true;
+    }
+
+    Scope scope_;
+    std::vector<Task> tasks_;
+    int errno_; // первая ошибка perf_event_open
+};
+
+#endif // PERF_COUNTERS_H_
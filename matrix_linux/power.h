@@ -0,0 +1,148 @@
+#ifndef POWER_H_
+#define POWER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "gemm.h"
+#include "matrix.h"
+#include "thread_pool.h"
+
+// Три квадратные матрицы, которые меняются ролями при возведении в степень:
+// основание, накопленный результат и приёмник очередного произведения.
+// Сохраняются между вызовами; после возведения результат отдаётся вызывающему,
+// поэтому на каждый вызов приходится одно выделение (сам результат).
+template<class Acc>
+struct PowerBuffers {
+    Matrix<Acc> base;
+    Matrix<Acc> result;
+    Matrix<Acc> product;
+    long long allocations;
+
+    PowerBuffers() : allocations(0) {}
+
+    void reserve(int n) {
+        for (Matrix<Acc>* m : { &base, &result, &product }) {
+            if (m->rows() != n || m->cols() != n) {
+                *m = Matrix<Acc>::uninitialized(n, n);
+                allocations++;
+            }
+        }
+    }
+};
+
+// Модуль для целочисленного возведения: значения в [0, modulus), произведения
+// накапливаются в int64_t, поэтому modulus не больше 2^31
+inline void checkPowerModulus(int64_t modulus) {
+    if (modulus < 1 || modulus > (int64_t(1) << 31)) {
+        throw std::invalid_argument("matrixPower: modulus must be in [1, 2^31]");
+    }
+}
+
+// Сколько слагаемых (modulus-1)^2 помещается в int64_t поверх значения меньше modulus
+inline int powerModChunk(int64_t modulus) {
+    const uint64_t maxProduct = static_cast<uint64_t>(modulus - 1) * static_cast<uint64_t>(modulus - 1);
+    if (maxProduct == 0) {
+        return std::numeric_limits<int>::max();
+    }
+    const uint64_t terms = (static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) - modulus) / maxProduct;
+    return static_cast<int>(std::min<uint64_t>(terms, std::numeric_limits<int>::max()));
+}
+
+// A^k двоичным возведением: не больше 2*log2(k) умножений. Основание возводится
+// в квадрат, на единичных битах k результат домножается на него; произведение
+// пишется в product, после чего product меняется местами с основанием или
+// результатом, так что внутри цикла память не выделяется.
+// modulus > 0 (только для Acc = int64_t): все значения приводятся в [0, modulus),
+// K проходится частями по powerModChunk, после каждой части плитка приводится по модулю.
+// products получает число выполненных умножений.
+template<class U, class P, class Acc>
+Matrix<Acc> matrixPower(const MicroKernel<P, Acc>& kernel, const BlockingParams& blocking, ThreadPool& pool,
+    MatrixView<const U> A, uint64_t k, PowerBuffers<Acc>& buffers, int64_t modulus, int& products) {
+    if (A.rows() != A.cols()) {
+        throw std::invalid_argument("matrixPower: matrix must be square");
+    }
+    const int n = A.rows();
+    int chunk = n;
+    if (modulus > 0) {
+        if (!std::is_same<Acc, int64_t>::value) {
+            throw std::invalid_argument("matrixPower: modular power needs int64_t accumulators");
+        }
+        checkPowerModulus(modulus);
+        chunk = powerModChunk(modulus);
+    }
+    products = 0;
+    buffers.reserve(n);
+
+    // Основание — копия A, приведённая по модулю
+    for (int i = 0; i < n; i++) {
+        const U* a = A.row(i);
+        Acc* b = buffers.base.row(i);
+        for (int j = 0; j < n; j++) {
+            if constexpr (std::is_integral<U>::value) {
+                if (modulus > 0) {
+                    const int64_t r = static_cast<int64_t>(a[j]) % modulus;
+                    b[j] = static_cast<Acc>(r < 0 ? r + modulus : r);
+                    continue;
+                }
+            }
+            b[j] = static_cast<Acc>(a[j]);
+        }
+    }
+
+    auto multiply = [&](const Matrix<Acc>& X, const Matrix<Acc>& Y) {
+        if constexpr (std::is_same<Acc, int64_t>::value) {
+            if (modulus > 0) {
+                const Acc m = static_cast<Acc>(modulus);
+                gemmParallelChunked(kernel, blocking, X.view(), Y.view(), buffers.product.view(), pool, chunk,
+                    [m](MatrixView<Acc> c) {
+                        for (int r = 0; r < c.rows(); r++) {
+                            Acc* row = c.row(r);
+                            for (int j = 0; j < c.cols(); j++) {
+                                row[j] %= m;
+                            }
+                        }
+                    });
+                products++;
+                return;
+            }
+        }
+        gemmParallel(kernel, blocking, X.view(), Y.view(), buffers.product.view(), pool);
+        products++;
+    };
+
+    bool haveResult = false;
+    if (k == 0) {
+        // Единичная матрица (по модулю 1 — нулевая)
+        const Acc one = modulus == 1 ? Acc() : Acc(1);
+        for (int i = 0; i < n; i++) {
+            std::fill(buffers.result.row(i), buffers.result.row(i) + n, Acc());
+            buffers.result(i, i) = one;
+        }
+        haveResult = true;
+    }
+    while (k > 0) {
+        if (k & 1) {
+            if (!haveResult) {
+                for (int i = 0; i < n; i++) {
+                    std::copy(buffers.base.row(i), buffers.base.row(i) + n, buffers.result.row(i));
+                }
+                haveResult = true;
+            } else {
+                multiply(buffers.result, buffers.base);
+                buffers.result.swap(buffers.product);
+            }
+        }
+        k >>= 1;
+        if (k > 0) {
+            multiply(buffers.base, buffers.base);
+            buffers.base.swap(buffers.product);
+        }
+    }
+    return std::move(buffers.result);
+}
+
+#endif // POWER_H_
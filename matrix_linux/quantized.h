@@ -0,0 +1,193 @@
+#ifndef QUANTIZED_H_
+#define QUANTIZED_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "gemm.h"
+#include "matrix.h"
+#include "simd_kernels.h"
+#include "thread_pool.h"
+
+// Матрица, квантованная в 8 бит: значение ≈ scale * (q - zeroPoint).
+// A хранится как u8 (асимметрично), B — как s8 (симметрично, zeroPoint = 0):
+// байт на элемент вместо четырёх у int32, ровно то, что принимают pmaddubsw / vpdpbusd.
+template<class Q>
+struct QuantizedMatrix {
+    Matrix<Q> values;
+    double scale;
+    int64_t zeroPoint; // целое окно A может лежать где угодно в диапазоне int64
+    int maxMagnitude; // наибольшее |q|, по нему выбирается ядро без насыщения
+
+    QuantizedMatrix() : scale(1.0), zeroPoint(0), maxMagnitude(0) {}
+
+    int rows() const { return values.rows(); }
+    int cols() const { return values.cols(); }
+};
+
+// A -> u8. Целые квантуются без потерь (scale = 1): значения должны умещаться в окно
+// из levels + 1 подряд идущих, zeroPoint = -минимум (по модулю 2^64). Вещественные делят
+// [min(0, минимум), max(0, максимум)] на levels ступеней, нуль представим точно;
+// levels = 127 оставляет q в 7 битах для ядер с насыщением.
+template<class T>
+QuantizedMatrix<uint8_t> quantizeUnsigned(MatrixView<const T> A, int levels = 255) {
+    if (levels < 1 || levels > 255) {
+        throw std::invalid_argument("quantizeUnsigned: levels must be in [1, 255]");
+    }
+    // Вещественным нужен точный нуль, целым — только их собственный диапазон
+    T low = std::is_integral<T>::value && !A.empty() ? A(0, 0) : T();
+    T high = low;
+    for (int i = 0; i < A.rows(); i++) {
+        for (int j = 0; j < A.cols(); j++) {
+            low = std::min(low, A(i, j));
+            high = std::max(high, A(i, j));
+        }
+    }
+    QuantizedMatrix<uint8_t> q;
+    q.values = Matrix<uint8_t>::uninitialized(A.rows(), A.cols());
+    if constexpr (std::is_integral<T>::value) {
+        // Разности в uint64_t: у окна возле границ int64 -минимум не представим как int64
+        const uint64_t base = static_cast<uint64_t>(static_cast<int64_t>(low));
+        if (static_cast<long double>(high) - static_cast<long double>(low) > levels) {
+            throw std::invalid_argument("quantizeUnsigned: integer values do not fit in 8 bits");
+        }
+        q.zeroPoint = static_cast<int64_t>(uint64_t(0) - base);
+        for (int i = 0; i < A.rows(); i++) {
+            for (int j = 0; j < A.cols(); j++) {
+                q.values(i, j) = static_cast<uint8_t>(static_cast<uint64_t>(static_cast<int64_t>(A(i, j))) - base);
+            }
+        }
+        q.maxMagnitude = static_cast<int>(static_cast<uint64_t>(static_cast<int64_t>(high)) - base);
+    } else {
+        const double range = static_cast<double>(high) - static_cast<double>(low);
+        q.scale = range > 0.0 ? range / levels : 1.0;
+        q.zeroPoint = std::lround(-static_cast<double>(low) / q.scale);
+        for (int i = 0; i < A.rows(); i++) {
+            for (int j = 0; j < A.cols(); j++) {
+                long v = std::lround(static_cast<double>(A(i, j)) / q.scale) + q.zeroPoint;
+                v = std::max(0L, std::min(v, static_cast<long>(levels)));
+                q.values(i, j) = static_cast<uint8_t>(v);
+                q.maxMagnitude = std::max(q.maxMagnitude, static_cast<int>(v));
+            }
+        }
+    }
+    return q;
+}
+
+// B -> s8 симметрично. Целые — без потерь, значения должны лежать в [-128, 127];
+// вещественные — со шкалой max|b| / 127.
+template<class T>
+QuantizedMatrix<int8_t> quantizeSigned(MatrixView<const T> B) {
+    QuantizedMatrix<int8_t> q;
+    q.values = Matrix<int8_t>::uninitialized(B.rows(), B.cols());
+    if constexpr (std::is_integral<T>::value) {
+        for (int i = 0; i < B.rows(); i++) {
+            for (int j = 0; j < B.cols(); j++) {
+                const int64_t v = static_cast<int64_t>(B(i, j));
+                if (v < -128 || v > 127) {
+                    throw std::invalid_argument("quantizeSigned: integer values do not fit in int8");
+                }
+                q.values(i, j) = static_cast<int8_t>(v);
+                q.maxMagnitude = std::max(q.maxMagnitude, static_cast<int>(v < 0 ? -v : v));
+            }
+        }
+    } else {
+        double peak = 0.0;
+        for (int i = 0; i < B.rows(); i++) {
+            for (int j = 0; j < B.cols(); j++) {
+                peak = std::max(peak, std::fabs(static_cast<double>(B(i, j))));
+            }
+        }
+        q.scale = peak > 0.0 ? peak / 127.0 : 1.0;
+        for (int i = 0; i < B.rows(); i++) {
+            for (int j = 0; j < B.cols(); j++) {
+                long v = std::lround(static_cast<double>(B(i, j)) / q.scale);
+                v = std::max(-127L, std::min(v, 127L));
+                q.values(i, j) = static_cast<int8_t>(v);
+                q.maxMagnitude = std::max(q.maxMagnitude, static_cast<int>(v < 0 ? -v : v));
+            }
+        }
+    }
+    return q;
+}
+
+// Самое широкое ядро, точное при |qA| <= maxA и |qB| <= maxB:
+// ядра с насыщением годятся, только пока пара произведений умещается в int16
+inline const QuantizedKernel& quantizedKernelFor(int maxA, int maxB) {
+    const std::vector<const QuantizedKernel*>& kernels = availableQuantizedKernels();
+    for (auto it = kernels.rbegin(); it != kernels.rend(); ++it) {
+        if (!(*it)->saturates || 2 * maxA * maxB <= std::numeric_limits<int16_t>::max()) {
+            return **it;
+        }
+    }
+    return *kernels.front();
+}
+
+// Ступеней для вещественной A: 7 бит, если самое широкое ядро насыщается на 8 битах
+inline int quantizedActivationLevels() {
+    return availableQuantizedKernels().back()->saturates ? 127 : 255;
+}
+
+// acc = qA * qB в int32 на пуле (без поправок на zeroPoint).
+// Суммы не переполняют int32, пока K * max|qA| * max|qB| <= 2^31 - 1.
+inline void gemmQuantized(const QuantizedKernel& kernel, const QuantizedMatrix<uint8_t>& A,
+    const QuantizedMatrix<int8_t>& B, MatrixView<int32_t> acc, ThreadPool& pool) {
+    if (A.cols() != B.rows() || acc.rows() != A.rows() || acc.cols() != B.cols()) {
+        throw std::invalid_argument("gemmQuantized: operand shapes do not match");
+    }
+    const int64_t bound = static_cast<int64_t>(A.cols()) * A.maxMagnitude * B.maxMagnitude;
+    if (bound > std::numeric_limits<int32_t>::max()) {
+        throw std::invalid_argument("gemmQuantized: K is too large for int32 accumulators");
+    }
+    const BlockingParams blocking = BlockingParams::forKernel(kernel.mr, kernel.nr, sizeof(uint8_t));
+    gemmParallel(kernel, blocking, A.values.view(), B.values.view(), acc, pool);
+}
+
+// C = scaleA * scaleB * (acc - zA * colsum(qB) - zB * rowsum(qA) + K * zA * zB).
+// Для целых операндов (scale = 1) результат точный: поправки считаются по модулю 2^64,
+// как переполнение при прямом умножении, так что большой zeroPoint ничего не портит.
+template<class R>
+void dequantize(MatrixView<const int32_t> acc, const QuantizedMatrix<uint8_t>& A,
+    const QuantizedMatrix<int8_t>& B, MatrixView<R> C) {
+    const int M = acc.rows();
+    const int N = acc.cols();
+    const int K = A.cols();
+    std::vector<int64_t> colSum(N, 0);
+    for (int k = 0; k < K; k++) {
+        const int8_t* brow = B.values.row(k);
+        for (int j = 0; j < N; j++) {
+            colSum[j] += brow[j];
+        }
+    }
+    const int64_t zA = A.zeroPoint;
+    const int64_t zB = B.zeroPoint;
+    const double scale = A.scale * B.scale;
+    for (int i = 0; i < M; i++) {
+        int64_t rowSum = 0;
+        if (zB != 0) {
+            const uint8_t* arow = A.values.row(i);
+            for (int k = 0; k < K; k++) {
+                rowSum += arow[k];
+            }
+        }
+        const uint64_t offset = static_cast<uint64_t>(K) * zA * zB - static_cast<uint64_t>(zB) * rowSum;
+        const int32_t* arow = acc.row(i);
+        R* crow = C.row(i);
+        for (int j = 0; j < N; j++) {
+            const uint64_t wrapped = static_cast<uint64_t>(static_cast<int64_t>(arow[j]))
+                - static_cast<uint64_t>(zA) * static_cast<uint64_t>(colSum[j]) + offset;
+            const int64_t exact = static_cast<int64_t>(wrapped);
+            if constexpr (std::is_integral<R>::value) {
+                crow[j] = static_cast<R>(exact);
+            } else {
+                crow[j] = static_cast<R>(scale * static_cast<double>(exact));
+            }
+        }
+    }
+}
+
+#endif // QUANTIZED_H_
@@ -0,0 +1,184 @@
+#ifndef RANDOM_FILL_H_
+#define RANDOM_FILL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "cpu_features.h"
+#include "detail.h"
+#include "matrix.h"
+#include "thread_pool.h"
+
+// Генератор со счётчиком: значение номер counter потока seed вычисляется сразу,
+// без состояния, как counter-й выход SplitMix64 из состояния counterKey(seed).
+// Элемент (i, j) матрицы cols столбцов получает номер i * cols + j, поэтому
+// результат не зависит от того, как строки и плитки распределены между потоками.
+
+const uint64_t kCounterGamma = detail::kSplitMixGamma;
+
+// Значения внутри одной группы считаются циклом постоянной длины, который векторизуется
+const int kRandomGroup = 16;
+
+// Разные seed дают несвязанные потоки: ключ — перемешанный seed
+inline uint64_t counterKey(uint64_t seed) {
+    return detail::mix64(seed + 0x6a09e667f3bcc909ull);
+}
+
+inline uint64_t counterRandom(uint64_t key, uint64_t counter) {
+    return detail::splitMix64(key + counter * kCounterGamma);
+}
+
+namespace random_detail {
+
+// Целые из [lo, lo + range): старшие 32 бита масштабируются умножением без деления.
+// Смещение не больше range / 2^32, для диапазонов матриц пренебрежимо.
+// Сумма считается в uint64_t (по модулю 2^64), чтобы не было знакового переполнения.
+template<class T>
+struct UniformNarrow {
+    uint64_t lo;
+    uint64_t range; // не больше 2^32
+    T operator()(uint64_t x) const {
+        return static_cast<T>(lo + (((x >> 32) * range) >> 32));
+    }
+};
+
+// Диапазон шире 2^32 (только 64-битные типы): 128-битное произведение
+template<class T>
+struct UniformWide {
+    uint64_t lo;
+    uint64_t range; // 0 — все 2^64 значений
+    T operator()(uint64_t x) const {
+        if (range == 0) {
+            return static_cast<T>(x);
+        }
+        return static_cast<T>(lo + static_cast<uint64_t>((static_cast<unsigned __int128>(x) * range) >> 64));
+    }
+};
+
+// Вещественные из [lo, hi): столько старших бит, сколько помещается в мантиссу
+template<class T>
+struct UniformReal {
+    T lo;
+    T scale; // hi - lo
+    T operator()(uint64_t x) const {
+        const int bits = std::numeric_limits<T>::digits;
+        const T unit = static_cast<T>(x >> (64 - bits)) * (T(1) / static_cast<T>(uint64_t(1) << bits));
+        return lo + scale * unit;
+    }
+};
+
+template<class T, class Map>
+__attribute__((always_inline)) inline void fillRowBody(T* out, int n, uint64_t key, uint64_t first,
+    const Map& shared) {
+    const Map map = shared; // локальная копия: запись в out не может изменить параметры
+    int j = 0;
+    for (; j + kRandomGroup <= n; j += kRandomGroup) {
+        const uint64_t base = first + j;
+        for (int s = 0; s < kRandomGroup; s++) {
+            out[j + s] = map(counterRandom(key, base + s));
+        }
+    }
+    for (; j < n; j++) {
+        out[j] = map(counterRandom(key, first + j));
+    }
+}
+
+template<class T, class Map>
+void fillRow(T* out, int n, uint64_t key, uint64_t first, const Map& map) {
+    fillRowBody(out, n, key, first, map);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template<class T, class Map>
+__attribute__((target("avx2")))
+void fillRowAvx2(T* out, int n, uint64_t key, uint64_t first, const Map& map) {
+    fillRowBody(out, n, key, first, map);
+}
+
+// AVX-512DQ умножает 64-битные целые одной инструкцией
+template<class T, class Map>
+__attribute__((target("avx512f,avx512bw,avx512dq")))
+void fillRowAvx512(T* out, int n, uint64_t key, uint64_t first, const Map& map) {
+    fillRowBody(out, n, key, first, map);
+}
+#endif
+
+template<class T, class Map>
+using FillRowKernel = void (*)(T* out, int n, uint64_t key, uint64_t first, const Map& map);
+
+template<class T, class Map>
+FillRowKernel<T, Map> selectFillRow() {
+#if defined(__x86_64__) || defined(__i386__)
+    const CpuFeatures& cpu = CpuFeatures::detect();
+    if (cpu.avx512f && cpu.avx512bw && cpu.avx512dq) {
+        return &fillRowAvx512<T, Map>;
+    }
+    if (cpu.avx2) {
+        return &fillRowAvx2<T, Map>;
+    }
+#endif
+    return &fillRow<T, Map>;
+}
+
+// Вызов fn(kernel, map) с отображением под тип T и диапазон [lo, hi]
+template<class T, class F>
+void withUniformMap(T lo, T hi, F&& fn) {
+    if constexpr (std::is_floating_point<T>::value) {
+        UniformReal<T> map = { lo, hi - lo };
+        fn(selectFillRow<T, UniformReal<T>>(), map);
+    } else {
+        static_assert(std::is_integral<T>::value, "fillUniform: integral or floating-point T");
+        const uint64_t low = static_cast<uint64_t>(static_cast<int64_t>(lo));
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(hi)) - low + 1;
+        if (range != 0 && range <= (uint64_t(1) << 32)) {
+            UniformNarrow<T> map = { low, range };
+            fn(selectFillRow<T, UniformNarrow<T>>(), map);
+        } else {
+            UniformWide<T> map = { low, range };
+            fn(selectFillRow<T, UniformWide<T>>(), map);
+        }
+    }
+}
+
+} // namespace random_detail
+
+// Строка из n значений с номерами first, first + 1, ...: целые из [lo, hi],
+// вещественные из [lo, hi)
+template<class T>
+void fillUniformRow(T* out, int n, uint64_t seed, uint64_t first, T lo, T hi) {
+    const uint64_t key = counterKey(seed);
+    random_detail::withUniformMap(lo, hi, [&](auto kernel, const auto& map) {
+        kernel(out, n, key, first, map);
+    });
+}
+
+// Параллельное заполнение по полосам строк на пуле. Элемент (i, j) получает
+// номер (rowOffset + i) * totalCols + colOffset + j, так что плитка большой матрицы,
+// заполненная со своими смещениями, совпадает с той же областью целой матрицы.
+// totalCols <= 0 — ширина самого представления.
+template<class T>
+void fillUniform(MatrixView<T> matrix, uint64_t seed, T lo, T hi, ThreadPool& pool,
+    int64_t rowOffset = 0, int64_t colOffset = 0, int64_t totalCols = 0) {
+    if (matrix.rows() <= 0 || matrix.cols() <= 0) {
+        return;
+    }
+    if (totalCols <= 0) {
+        totalCols = matrix.cols();
+    }
+    const uint64_t key = counterKey(seed);
+    const int rows = matrix.rows();
+    const int chunks = detail::chunkCount(rows, pool);
+    random_detail::withUniformMap(lo, hi, [&](auto kernel, const auto& map) {
+        pool.parallelFor(chunks, [&](int chunk) {
+            const int begin = detail::chunkBegin(rows, chunks, chunk);
+            const int end = detail::chunkBegin(rows, chunks, chunk + 1);
+            for (int i = begin; i < end; i++) {
+                const uint64_t first = static_cast<uint64_t>((rowOffset + i) * totalCols + colOffset);
+                kernel(matrix.row(i), matrix.cols(), key, first, map);
+            }
+        });
+    });
+}
+
+#endif // RANDOM_FILL_H_
@@ -0,0 +1,719 @@
+#ifndef SIMD_KERNELS_H_
+#define SIMD_KERNELS_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "cpu_features.h"
+#include "gemm.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_KERNELS_X86 1
+#else
+#define SIMD_KERNELS_X86 0
+#endif
+
+#if SIMD_KERNELS_X86
+#include <immintrin.h>
+
+// Все микроядра — 6 x (2 вектора): 12 аккумуляторов в регистрах.
+
+// Микроядра int32.
+// Умножение и сложение идут по модулю 2^32, как и в скалярном коде,
+// поэтому результат побитово совпадает с multiplySequential.
+
+__attribute__((target("sse4.1")))
+inline void sse41MicroKernel6x8(int kc, const int* a, const int* b, int* c, int ldc) {
+    __m128i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm_setzero_si128();
+        acc[r][1] = _mm_setzero_si128();
+    }
+    for (int k = 0; k < kc; k++) {
+        __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 4));
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            __m128i av = _mm_set1_epi32(a[r]);
+            acc[r][0] = _mm_add_epi32(acc[r][0], _mm_mullo_epi32(av, b0));
+            acc[r][1] = _mm_add_epi32(acc[r][1], _mm_mullo_epi32(av, b1));
+        }
+        a += 6;
+        b += 8;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        __m128i* crow = reinterpret_cast<__m128i*>(c + static_cast<size_t>(r) * ldc);
+        _mm_storeu_si128(crow, _mm_add_epi32(_mm_loadu_si128(crow), acc[r][0]));
+        _mm_storeu_si128(crow + 1, _mm_add_epi32(_mm_loadu_si128(crow + 1), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx2")))
+inline void avx2MicroKernel6x16(int kc, const int* a, const int* b, int* c, int ldc) {
+    __m256i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm256_setzero_si256();
+        acc[r][1] = _mm256_setzero_si256();
+    }
+    for (int k = 0; k < kc; k++) {
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 8));
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            __m256i av = _mm256_set1_epi32(a[r]);
+            acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_mullo_epi32(av, b0));
+            acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_mullo_epi32(av, b1));
+        }
+        a += 6;
+        b += 16;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        __m256i* crow = reinterpret_cast<__m256i*>(c + static_cast<size_t>(r) * ldc);
+        _mm256_storeu_si256(crow, _mm256_add_epi32(_mm256_loadu_si256(crow), acc[r][0]));
+        _mm256_storeu_si256(crow + 1, _mm256_add_epi32(_mm256_loadu_si256(crow + 1), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void avx512MicroKernel6x32(int kc, const int* a, const int* b, int* c, int ldc) {
+    __m512i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm512_setzero_si512();
+        acc[r][1] = _mm512_setzero_si512();
+    }
+    for (int k = 0; k < kc; k++) {
+        __m512i b0 = _mm512_loadu_si512(b);
+        __m512i b1 = _mm512_loadu_si512(b + 16);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            __m512i av = _mm512_set1_epi32(a[r]);
+            acc[r][0] = _mm512_add_epi32(acc[r][0], _mm512_mullo_epi32(av, b0));
+            acc[r][1] = _mm512_add_epi32(acc[r][1], _mm512_mullo_epi32(av, b1));
+        }
+        a += 6;
+        b += 32;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        int* crow = c + static_cast<size_t>(r) * ldc;
+        _mm512_storeu_si512(crow, _mm512_add_epi32(_mm512_loadu_si512(crow), acc[r][0]));
+        _mm512_storeu_si512(crow + 16, _mm512_add_epi32(_mm512_loadu_si512(crow + 16), acc[r][1]));
+    }
+}
+
+// int16 x int16 -> int32 через pmaddwd: пары соседних k упакованы подряд (kGroup = 2).
+// Подходит и для int8: значения расширяются до int16 при упаковке.
+
+__attribute__((target("avx2")))
+inline void avx2MaddMicroKernel6x16(int kc, const int16_t* a, const int16_t* b, int32_t* c, int ldc) {
+    __m256i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm256_setzero_si256();
+        acc[r][1] = _mm256_setzero_si256();
+    }
+    for (int k = 0; k < kc; k += 2) {
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 16));
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            int32_t pair;
+            std::memcpy(&pair, a + 2 * r, sizeof(pair));
+            __m256i av = _mm256_set1_epi32(pair);
+            acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_madd_epi16(av, b0));
+            acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_madd_epi16(av, b1));
+        }
+        a += 12;
+        b += 32;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        __m256i* crow = reinterpret_cast<__m256i*>(c + static_cast<size_t>(r) * ldc);
+        _mm256_storeu_si256(crow, _mm256_add_epi32(_mm256_loadu_si256(crow), acc[r][0]));
+        _mm256_storeu_si256(crow + 1, _mm256_add_epi32(_mm256_loadu_si256(crow + 1), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline void avx512MaddMicroKernel6x32(int kc, const int16_t* a, const int16_t* b, int32_t* c, int ldc) {
+    __m512i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm512_setzero_si512();
+        acc[r][1] = _mm512_setzero_si512();
+    }
+    for (int k = 0; k < kc; k += 2) {
+        __m512i b0 = _mm512_loadu_si512(b);
+        __m512i b1 = _mm512_loadu_si512(b + 32);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            int32_t pair;
+            std::memcpy(&pair, a + 2 * r, sizeof(pair));
+            __m512i av = _mm512_set1_epi32(pair);
+            acc[r][0] = _mm512_add_epi32(acc[r][0], _mm512_madd_epi16(av, b0));
+            acc[r][1] = _mm512_add_epi32(acc[r][1], _mm512_madd_epi16(av, b1));
+        }
+        a += 12;
+        b += 64;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        int32_t* crow = c + static_cast<size_t>(r) * ldc;
+        _mm512_storeu_si512(crow, _mm512_add_epi32(_mm512_loadu_si512(crow), acc[r][0]));
+        _mm512_storeu_si512(crow + 16, _mm512_add_epi32(_mm512_loadu_si512(crow + 16), acc[r][1]));
+    }
+}
+
+// int32 x int32 -> int64: значения упакованы как int64 со знаковым расширением,
+// pmuldq перемножает младшие 32 бита каждой 64-битной дорожки без потери точности.
+
+__attribute__((target("avx2")))
+inline void avx2WideMicroKernel6x8(int kc, const int64_t* a, const int64_t* b, int64_t* c, int ldc) {
+    __m256i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm256_setzero_si256();
+        acc[r][1] = _mm256_setzero_si256();
+    }
+    for (int k = 0; k < kc; k++) {
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 4));
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            __m256i av = _mm256_set1_epi64x(a[r]);
+            acc[r][0] = _mm256_add_epi64(acc[r][0], _mm256_mul_epi32(av, b0));
+            acc[r][1] = _mm256_add_epi64(acc[r][1], _mm256_mul_epi32(av, b1));
+        }
+        a += 6;
+        b += 8;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        __m256i* crow = reinterpret_cast<__m256i*>(c + static_cast<size_t>(r) * ldc);
+        _mm256_storeu_si256(crow, _mm256_add_epi64(_mm256_loadu_si256(crow), acc[r][0]));
+        _mm256_storeu_si256(crow + 1, _mm256_add_epi64(_mm256_loadu_si256(crow + 1), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void avx512WideMicroKernel6x16(int kc, const int64_t* a, const int64_t* b, int64_t* c, int ldc) {
+    __m512i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm512_setzero_si512();
+        acc[r][1] = _mm512_setzero_si512();
+    }
+    for (int k = 0; k < kc; k++) {
+        __m512i b0 = _mm512_loadu_si512(b);
+        __m512i b1 = _mm512_loadu_si512(b + 8);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            __m512i av = _mm512_set1_epi64(a[r]);
+            // maskz с полной маской — тот же vpmuldq, но без ложного -Wmaybe-uninitialized в GCC 12
+            acc[r][0] = _mm512_add_epi64(acc[r][0], _mm512_maskz_mul_epi32(0xFF, av, b0));
+            acc[r][1] = _mm512_add_epi64(acc[r][1], _mm512_maskz_mul_epi32(0xFF, av, b1));
+        }
+        a += 6;
+        b += 16;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        int64_t* crow = c + static_cast<size_t>(r) * ldc;
+        _mm512_storeu_si512(crow, _mm512_add_epi64(_mm512_loadu_si512(crow), acc[r][0]));
+        _mm512_storeu_si512(crow + 8, _mm512_add_epi64(_mm512_loadu_si512(crow + 8), acc[r][1]));
+    }
+}
+
+// int64 x int64 -> int64: 64-битное умножение есть только в AVX-512DQ
+__attribute__((target("avx512f,avx512dq")))
+inline void avx512Int64MicroKernel6x16(int kc, const int64_t* a, const int64_t* b, int64_t* c, int ldc) {
+    __m512i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm512_setzero_si512();
+        acc[r][1] = _mm512_setzero_si512();
+    }
+    for (int k = 0; k < kc; k++) {
+        __m512i b0 = _mm512_loadu_si512(b);
+        __m512i b1 = _mm512_loadu_si512(b + 8);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            __m512i av = _mm512_set1_epi64(a[r]);
+            acc[r][0] = _mm512_add_epi64(acc[r][0], _mm512_mullo_epi64(av, b0));
+            acc[r][1] = _mm512_add_epi64(acc[r][1], _mm512_mullo_epi64(av, b1));
+        }
+        a += 6;
+        b += 16;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        int64_t* crow = c + static_cast<size_t>(r) * ldc;
+        _mm512_storeu_si512(crow, _mm512_add_epi64(_mm512_loadu_si512(crow), acc[r][0]));
+        _mm512_storeu_si512(crow + 8, _mm512_add_epi64(_mm512_loadu_si512(crow + 8), acc[r][1]));
+    }
+}
+
+// Вещественные микроядра на FMA: порядок суммирования отличается от
+// multiplySequential, поэтому результат сравнивается с допуском (areMatricesClose).
+
+__attribute__((target("avx2,fma")))
+inline void avx2FmaMicroKernel6x16(int kc, const float* a, const float* b, float* c, int ldc) {
+    __m256 acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm256_setzero_ps();
+        acc[r][1] = _mm256_setzero_ps();
+    }
+    for (int k = 0; k < kc; k++) {
+        __m256 b0 = _mm256_loadu_ps(b);
+        __m256 b1 = _mm256_loadu_ps(b + 8);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            __m256 av = _mm256_set1_ps(a[r]);
+            acc[r][0] = _mm256_fmadd_ps(av, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(av, b1, acc[r][1]);
+        }
+        a += 6;
+        b += 16;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        float* crow = c + static_cast<size_t>(r) * ldc;
+        _mm256_storeu_ps(crow, _mm256_add_ps(_mm256_loadu_ps(crow), acc[r][0]));
+        _mm256_storeu_ps(crow + 8, _mm256_add_ps(_mm256_loadu_ps(crow + 8), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void avx512FmaMicroKernel6x32(int kc, const float* a, const float* b, float* c, int ldc) {
+    __m512 acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm512_setzero_ps();
+        acc[r][1] = _mm512_setzero_ps();
+    }
+    for (int k = 0; k < kc; k++) {
+        __m512 b0 = _mm512_loadu_ps(b);
+        __m512 b1 = _mm512_loadu_ps(b + 16);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            __m512 av = _mm512_set1_ps(a[r]);
+            acc[r][0] = _mm512_fmadd_ps(av, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_ps(av, b1, acc[r][1]);
+        }
+        a += 6;
+        b += 32;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        float* crow = c + static_cast<size_t>(r) * ldc;
+        _mm512_storeu_ps(crow, _mm512_add_ps(_mm512_loadu_ps(crow), acc[r][0]));
+        _mm512_storeu_ps(crow + 16, _mm512_add_ps(_mm512_loadu_ps(crow + 16), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline void avx2FmaMicroKernel6x8(int kc, const double* a, const double* b, double* c, int ldc) {
+    __m256d acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm256_setzero_pd();
+        acc[r][1] = _mm256_setzero_pd();
+    }
+    for (int k = 0; k < kc; k++) {
+        __m256d b0 = _mm256_loadu_pd(b);
+        __m256d b1 = _mm256_loadu_pd(b + 4);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            __m256d av = _mm256_set1_pd(a[r]);
+            acc[r][0] = _mm256_fmadd_pd(av, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_pd(av, b1, acc[r][1]);
+        }
+        a += 6;
+        b += 8;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        double* crow = c + static_cast<size_t>(r) * ldc;
+        _mm256_storeu_pd(crow, _mm256_add_pd(_mm256_loadu_pd(crow), acc[r][0]));
+        _mm256_storeu_pd(crow + 4, _mm256_add_pd(_mm256_loadu_pd(crow + 4), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void avx512FmaMicroKernel6x16(int kc, const double* a, const double* b, double* c, int ldc) {
+    __m512d acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm512_setzero_pd();
+        acc[r][1] = _mm512_setzero_pd();
+    }
+    for (int k = 0; k < kc; k++) {
+        __m512d b0 = _mm512_loadu_pd(b);
+        __m512d b1 = _mm512_loadu_pd(b + 8);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            __m512d av = _mm512_set1_pd(a[r]);
+            acc[r][0] = _mm512_fmadd_pd(av, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_pd(av, b1, acc[r][1]);
+        }
+        a += 6;
+        b += 16;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        double* crow = c + static_cast<size_t>(r) * ldc;
+        _mm512_storeu_pd(crow, _mm512_add_pd(_mm512_loadu_pd(crow), acc[r][0]));
+        _mm512_storeu_pd(crow + 8, _mm512_add_pd(_mm512_loadu_pd(crow + 8), acc[r][1]));
+    }
+}
+
+// u8 x s8 -> int32: четыре соседних k упакованы подряд (kGroup = 4), строка A —
+// одно 32-битное слово, столбец B — 32-битная дорожка вектора. vpdpbusd складывает
+// четыре произведения сразу в int32; pmaddubsw сначала складывает пары в int16
+// с насыщением, затем pmaddwd с единицами дополняет до четвёрки в int32.
+
+__attribute__((target("avx2")))
+inline void avx2MaddubsMicroKernel6x16(int kc, const uint8_t* a, const int8_t* b, int32_t* c, int ldc) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm256_setzero_si256();
+        acc[r][1] = _mm256_setzero_si256();
+    }
+    for (int k = 0; k < kc; k += 4) {
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 32));
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            int32_t quad;
+            std::memcpy(&quad, a + 4 * r, sizeof(quad));
+            __m256i av = _mm256_set1_epi32(quad);
+            acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_madd_epi16(_mm256_maddubs_epi16(av, b0), ones));
+            acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_madd_epi16(_mm256_maddubs_epi16(av, b1), ones));
+        }
+        a += 24;
+        b += 64;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        __m256i* crow = reinterpret_cast<__m256i*>(c + static_cast<size_t>(r) * ldc);
+        _mm256_storeu_si256(crow, _mm256_add_epi32(_mm256_loadu_si256(crow), acc[r][0]));
+        _mm256_storeu_si256(crow + 1, _mm256_add_epi32(_mm256_loadu_si256(crow + 1), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx2,avxvnni")))
+inline void avxVnniMicroKernel6x16(int kc, const uint8_t* a, const int8_t* b, int32_t* c, int ldc) {
+    __m256i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm256_setzero_si256();
+        acc[r][1] = _mm256_setzero_si256();
+    }
+    for (int k = 0; k < kc; k += 4) {
+        __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 32));
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            int32_t quad;
+            std::memcpy(&quad, a + 4 * r, sizeof(quad));
+            __m256i av = _mm256_set1_epi32(quad);
+            acc[r][0] = _mm256_dpbusd_avx_epi32(acc[r][0], av, b0);
+            acc[r][1] = _mm256_dpbusd_avx_epi32(acc[r][1], av, b1);
+        }
+        a += 24;
+        b += 64;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        __m256i* crow = reinterpret_cast<__m256i*>(c + static_cast<size_t>(r) * ldc);
+        _mm256_storeu_si256(crow, _mm256_add_epi32(_mm256_loadu_si256(crow), acc[r][0]));
+        _mm256_storeu_si256(crow + 1, _mm256_add_epi32(_mm256_loadu_si256(crow + 1), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline void avx512MaddubsMicroKernel6x32(int kc, const uint8_t* a, const int8_t* b, int32_t* c, int ldc) {
+    const __m512i ones = _mm512_set1_epi16(1);
+    __m512i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm512_setzero_si512();
+        acc[r][1] = _mm512_setzero_si512();
+    }
+    for (int k = 0; k < kc; k += 4) {
+        __m512i b0 = _mm512_loadu_si512(b);
+        __m512i b1 = _mm512_loadu_si512(b + 64);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            int32_t quad;
+            std::memcpy(&quad, a + 4 * r, sizeof(quad));
+            __m512i av = _mm512_set1_epi32(quad);
+            acc[r][0] = _mm512_add_epi32(acc[r][0], _mm512_madd_epi16(_mm512_maddubs_epi16(av, b0), ones));
+            acc[r][1] = _mm512_add_epi32(acc[r][1], _mm512_madd_epi16(_mm512_maddubs_epi16(av, b1), ones));
+        }
+        a += 24;
+        b += 128;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        int32_t* crow = c + static_cast<size_t>(r) * ldc;
+        _mm512_storeu_si512(crow, _mm512_add_epi32(_mm512_loadu_si512(crow), acc[r][0]));
+        _mm512_storeu_si512(crow + 16, _mm512_add_epi32(_mm512_loadu_si512(crow + 16), acc[r][1]));
+    }
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+inline void avx512VnniMicroKernel6x32(int kc, const uint8_t* a, const int8_t* b, int32_t* c, int ldc) {
+    __m512i acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm512_setzero_si512();
+        acc[r][1] = _mm512_setzero_si512();
+    }
+    for (int k = 0; k < kc; k += 4) {
+        __m512i b0 = _mm512_loadu_si512(b);
+        __m512i b1 = _mm512_loadu_si512(b + 64);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; r++) {
+            int32_t quad;
+            std::memcpy(&quad, a + 4 * r, sizeof(quad));
+            __m512i av = _mm512_set1_epi32(quad);
+            acc[r][0] = _mm512_dpbusd_epi32(acc[r][0], av, b0);
+            acc[r][1] = _mm512_dpbusd_epi32(acc[r][1], av, b1);
+        }
+        a += 24;
+        b += 128;
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; r++) {
+        int32_t* crow = c + static_cast<size_t>(r) * ldc;
+        _mm512_storeu_si512(crow, _mm512_add_epi32(_mm512_loadu_si512(crow), acc[r][0]));
+        _mm512_storeu_si512(crow + 16, _mm512_add_epi32(_mm512_loadu_si512(crow + 16), acc[r][1]));
+    }
+}
+#endif
+
+// Набор микроядер для пары (тип элементов, тип аккумулятора).
+// Определён только для поддерживаемых пар; Packed — тип упакованных панелей.
+// Скалярное ядро всегда первое, дальше — по возрастанию ширины.
+template<class T, class Acc>
+struct KernelSet;
+
+template<>
+struct KernelSet<int32_t, int32_t> {
+    typedef int32_t Packed;
+
+    static const std::vector<const MicroKernel<Packed, int32_t>*>& available() {
+        static const std::vector<const MicroKernel<Packed, int32_t>*> kernels = []() {
+            std::vector<const MicroKernel<Packed, int32_t>*> list;
+            list.push_back(&scalarKernel<Packed, int32_t>());
+#if SIMD_KERNELS_X86
+            static const MicroKernel<Packed, int32_t> sse41 = { "sse4.1", 6, 8, &sse41MicroKernel6x8 };
+            static const MicroKernel<Packed, int32_t> avx2 = { "avx2", 6, 16, &avx2MicroKernel6x16 };
+            static const MicroKernel<Packed, int32_t> avx512 = { "avx512", 6, 32, &avx512MicroKernel6x32 };
+            const CpuFeatures& cpu = CpuFeatures::detect();
+            if (cpu.sse41) {
+                list.push_back(&sse41);
+            }
+            if (cpu.avx2) {
+                list.push_back(&avx2);
+            }
+            if (cpu.avx512f) {
+                list.push_back(&avx512);
+            }
+#endif
+            return list;
+        }();
+        return kernels;
+    }
+};
+
+template<>
+struct KernelSet<int16_t, int32_t> {
+    typedef int16_t Packed;
+
+    static const std::vector<const MicroKernel<Packed, int32_t>*>& available() {
+        static const std::vector<const MicroKernel<Packed, int32_t>*> kernels = []() {
+            std::vector<const MicroKernel<Packed, int32_t>*> list;
+            list.push_back(&scalarKernel<Packed, int32_t>());
+#if SIMD_KERNELS_X86
+            static const MicroKernel<Packed, int32_t> avx2 = { "avx2-madd", 6, 16, &avx2MaddMicroKernel6x16, 2 };
+            static const MicroKernel<Packed, int32_t> avx512 = { "avx512-madd", 6, 32, &avx512MaddMicroKernel6x32, 2 };
+            const CpuFeatures& cpu = CpuFeatures::detect();
+            if (cpu.avx2) {
+                list.push_back(&avx2);
+            }
+            if (cpu.avx512bw) {
+                list.push_back(&avx512);
+            }
+#endif
+            return list;
+        }();
+        return kernels;
+    }
+};
+
+// int8 использует ядра int16: при упаковке значения расширяются до int16
+template<>
+struct KernelSet<int8_t, int32_t> : KernelSet<int16_t, int32_t> {};
+
+template<>
+struct KernelSet<int32_t, int64_t> {
+    typedef int64_t Packed;
+
+    static const std::vector<const MicroKernel<Packed, int64_t>*>& available() {
+        static const std::vector<const MicroKernel<Packed, int64_t>*> kernels = []() {
+            std::vector<const MicroKernel<Packed, int64_t>*> list;
+            list.push_back(&scalarKernel<Packed, int64_t>());
+#if SIMD_KERNELS_X86
+            static const MicroKernel<Packed, int64_t> avx2 = { "avx2-pmuldq", 6, 8, &avx2WideMicroKernel6x8 };
+            static const MicroKernel<Packed, int64_t> avx512 = { "avx512-pmuldq", 6, 16, &avx512WideMicroKernel6x16 };
+            const CpuFeatures& cpu = CpuFeatures::detect();
+            if (cpu.avx2) {
+                list.push_back(&avx2);
+            }
+            if (cpu.avx512f) {
+                list.push_back(&avx512);
+            }
+#endif
+            return list;
+        }();
+        return kernels;
+    }
+};
+
+template<>
+struct KernelSet<int64_t, int64_t> {
+    typedef int64_t Packed;
+
+    static const std::vector<const MicroKernel<Packed, int64_t>*>& available() {
+        static const std::vector<const MicroKernel<Packed, int64_t>*> kernels = []() {
+            std::vector<const MicroKernel<Packed, int64_t>*> list;
+            list.push_back(&scalarKernel<Packed, int64_t>());
+#if SIMD_KERNELS_X86
+            static const MicroKernel<Packed, int64_t> avx512 = { "avx512dq", 6, 16, &avx512Int64MicroKernel6x16 };
+            if (CpuFeatures::detect().avx512dq) {
+                list.push_back(&avx512);
+            }
+#endif
+            return list;
+        }();
+        return kernels;
+    }
+};
+
+template<>
+struct KernelSet<float, float> {
+    typedef float Packed;
+
+    static const std::vector<const MicroKernel<Packed, float>*>& available() {
+        static const std::vector<const MicroKernel<Packed, float>*> kernels = []() {
+            std::vector<const MicroKernel<Packed, float>*> list;
+            list.push_back(&scalarKernel<Packed, float>());
+#if SIMD_KERNELS_X86
+            static const MicroKernel<Packed, float> avx2 = { "avx2-fma", 6, 16, &avx2FmaMicroKernel6x16 };
+            static const MicroKernel<Packed, float> avx512 = { "avx512-fma", 6, 32, &avx512FmaMicroKernel6x32 };
+            const CpuFeatures& cpu = CpuFeatures::detect();
+            if (cpu.fma) {
+                list.push_back(&avx2);
+            }
+            if (cpu.avx512f) {
+                list.push_back(&avx512);
+            }
+#endif
+            return list;
+        }();
+        return kernels;
+    }
+};
+
+template<>
+struct KernelSet<double, double> {
+    typedef double Packed;
+
+    static const std::vector<const MicroKernel<Packed, double>*>& available() {
+        static const std::vector<const MicroKernel<Packed, double>*> kernels = []() {
+            std::vector<const MicroKernel<Packed, double>*> list;
+            list.push_back(&scalarKernel<Packed, double>());
+#if SIMD_KERNELS_X86
+            static const MicroKernel<Packed, double> avx2 = { "avx2-fma", 6, 8, &avx2FmaMicroKernel6x8 };
+            static const MicroKernel<Packed, double> avx512 = { "avx512-fma", 6, 16, &avx512FmaMicroKernel6x16 };
+            const CpuFeatures& cpu = CpuFeatures::detect();
+            if (cpu.fma) {
+                list.push_back(&avx2);
+            }
+            if (cpu.avx512f) {
+                list.push_back(&avx512);
+            }
+#endif
+            return list;
+        }();
+        return kernels;
+    }
+};
+
+// Микроядра u8 x s8 -> int32 для квантованного умножения (quantized.h), от скалярного
+// к самому широкому. Ядра с saturates точны не для всех значений.
+typedef MicroKernel<uint8_t, int32_t, int8_t> QuantizedKernel;
+
+inline const std::vector<const QuantizedKernel*>& availableQuantizedKernels() {
+    static const std::vector<const QuantizedKernel*> kernels = []() {
+        std::vector<const QuantizedKernel*> list;
+        list.push_back(&scalarKernel<uint8_t, int32_t, int8_t>());
+#if SIMD_KERNELS_X86
+        static const QuantizedKernel avx2 = { "avx2-maddubs", 6, 16, &avx2MaddubsMicroKernel6x16, 4, true };
+        static const QuantizedKernel avxVnni = { "avx-vnni", 6, 16, &avxVnniMicroKernel6x16, 4 };
+        static const QuantizedKernel avx512 = { "avx512-maddubs", 6, 32, &avx512MaddubsMicroKernel6x32, 4, true };
+        static const QuantizedKernel avx512Vnni = { "avx512-vnni", 6, 32, &avx512VnniMicroKernel6x32, 4 };
+        const CpuFeatures& cpu = CpuFeatures::detect();
+        if (cpu.avx2) {
+            list.push_back(&avx2);
+        }
+        if (cpu.avxvnni) {
+            list.push_back(&avxVnni);
+        }
+        if (cpu.avx512bw) {
+            list.push_back(&avx512);
+        }
+        if (cpu.avx512vnni) {
+            list.push_back(&avx512Vnni);
+        }
+#endif
+        return list;
+    }();
+    return kernels;
+}
+
+// Все микроядра для (T, Acc), поддерживаемые текущим процессором
+template<class T = int, class Acc = typename DefaultAccumulator<T>::type>
+const std::vector<const MicroKernel<typename KernelSet<T, Acc>::Packed, Acc>*>& availableKernels() {
+    return KernelSet<T, Acc>::available();
+}
+
+// Самое широкое доступное микроядро (выбирается один раз при первом вызове)
+template<class T = int, class Acc = typename DefaultAccumulator<T>::type>
+const MicroKernel<typename KernelSet<T, Acc>::Packed, Acc>& bestKernel() {
+    return *availableKernels<T, Acc>().back();
+}
+
+// Поиск микроядра по имени; nullptr, если процессор его не поддерживает
+template<class T = int, class Acc = typename DefaultAccumulator<T>::type>
+const MicroKernel<typename KernelSet<T, Acc>::Packed, Acc>* findKernel(const std::string& name) {
+    for (const auto* kernel : availableKernels<T, Acc>()) {
+        if (name == kernel->name) {
+            return kernel;
+        }
+    }
+    return nullptr;
+}
+
+#endif // SIMD_KERNELS_H_
@@ -0,0 +1,308 @@
+#ifndef SPARSE_H_
+#define SPARSE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include "detail.h"
+#include "matrix.h"
+#include "thread_pool.h"
+
+// Разреженная матрица по строкам (CSR): ненулевые строки i лежат в
+// colIndex/values[rowPtr[i], rowPtr[i + 1]), столбцы внутри строки возрастают
+template<class T>
+struct CsrMatrix {
+    int rows;
+    int cols;
+    std::vector<size_t> rowPtr;
+    std::vector<int> colIndex;
+    std::vector<T> values;
+
+    CsrMatrix() : rows(0), cols(0), rowPtr(1, 0) {}
+
+    size_t nnz() const { return values.size(); }
+    double density() const {
+        return rows > 0 && cols > 0 ? static_cast<double>(nnz()) / rows / cols : 0.0;
+    }
+};
+
+// Разреженная матрица по столбцам (CSC): ненулевые столбца j лежат в
+// rowIndex/values[colPtr[j], colPtr[j + 1]), строки внутри столбца возрастают
+template<class T>
+struct CscMatrix {
+    int rows;
+    int cols;
+    std::vector<size_t> colPtr;
+    std::vector<int> rowIndex;
+    std::vector<T> values;
+
+    CscMatrix() : rows(0), cols(0), colPtr(1, 0) {}
+
+    size_t nnz() const { return values.size(); }
+    double density() const {
+        return rows > 0 && cols > 0 ? static_cast<double>(nnz()) / rows / cols : 0.0;
+    }
+};
+
+// Пороги плотности для автоматического выбора разреженного пути. На 800 x 800
+// (AVX-512) CSR x плотная догоняет блочное ядро при плотности A около 5%,
+// плотная x CSC — при плотности B около 2%.
+const double kSparseRowsDensity = 0.05;
+const double kSparseColsDensity = 0.02;
+
+namespace sparse_detail {
+
+// Префиксные суммы счётчиков: counts[i] превращается в начало i, возвращается итог
+inline size_t exclusiveScan(std::vector<size_t>& counts) {
+    size_t total = 0;
+    for (size_t& count : counts) {
+        size_t value = count;
+        count = total;
+        total += value;
+    }
+    return total;
+}
+
+} // namespace sparse_detail
+
+// Число ненулевых элементов (параллельно по полосам строк)
+template<class T>
+size_t countNonZeros(const Matrix<T>& A, ThreadPool& pool) {
+    const int chunks = detail::chunkCount(A.rows(), pool);
+    std::vector<size_t> counts(chunks, 0);
+    pool.parallelFor(chunks, [&](int chunk) {
+        size_t count = 0;
+        for (int i = detail::chunkBegin(A.rows(), chunks, chunk);
+             i < detail::chunkBegin(A.rows(), chunks, chunk + 1); i++) {
+            const T* a = A.row(i);
+            for (int j = 0; j < A.cols(); j++) {
+                count += a[j] != T() ? 1 : 0;
+            }
+        }
+        counts[chunk] = count;
+    });
+    size_t total = 0;
+    for (size_t count : counts) {
+        total += count;
+    }
+    return total;
+}
+
+// Плотная -> CSR в два параллельных прохода: подсчёт по строкам и заполнение
+template<class T>
+CsrMatrix<T> toCsr(const Matrix<T>& A, ThreadPool& pool) {
+    CsrMatrix<T> result;
+    result.rows = A.rows();
+    result.cols = A.cols();
+    result.rowPtr.assign(A.rows() + 1, 0);
+    const int chunks = detail::chunkCount(A.rows(), pool);
+
+    pool.parallelFor(chunks, [&](int chunk) {
+        for (int i = detail::chunkBegin(A.rows(), chunks, chunk);
+             i < detail::chunkBegin(A.rows(), chunks, chunk + 1); i++) {
+            const T* a = A.row(i);
+            size_t count = 0;
+            for (int j = 0; j < A.cols(); j++) {
+                count += a[j] != T() ? 1 : 0;
+            }
+            result.rowPtr[i] = count;
+        }
+    });
+    size_t nnz = sparse_detail::exclusiveScan(result.rowPtr);
+    result.colIndex.resize(nnz);
+    result.values.resize(nnz);
+
+    pool.parallelFor(chunks, [&](int chunk) {
+        for (int i = detail::chunkBegin(A.rows(), chunks, chunk);
+             i < detail::chunkBegin(A.rows(), chunks, chunk + 1); i++) {
+            const T* a = A.row(i);
+            size_t out = result.rowPtr[i];
+            for (int j = 0; j < A.cols(); j++) {
+                if (a[j] != T()) {
+                    result.colIndex[out] = j;
+                    result.values[out] = a[j];
+                    out++;
+                }
+            }
+        }
+    });
+    return result;
+}
+
+// Плотная -> CSC: полосы столбцов обрабатываются параллельно, строки читаются подряд
+template<class T>
+CscMatrix<T> toCsc(const Matrix<T>& A, ThreadPool& pool) {
+    CscMatrix<T> result;
+    result.rows = A.rows();
+    result.cols = A.cols();
+    result.colPtr.assign(A.cols() + 1, 0);
+    const int chunks = detail::chunkCount(A.cols(), pool);
+
+    pool.parallelFor(chunks, [&](int chunk) {
+        int begin = detail::chunkBegin(A.cols(), chunks, chunk);
+        int end = detail::chunkBegin(A.cols(), chunks, chunk + 1);
+        for (int i = 0; i < A.rows(); i++) {
+            const T* a = A.row(i);
+            for (int j = begin; j < end; j++) {
+                result.colPtr[j] += a[j] != T() ? 1 : 0;
+            }
+        }
+    });
+    size_t nnz = sparse_detail::exclusiveScan(result.colPtr);
+    result.rowIndex.resize(nnz);
+    result.values.resize(nnz);
+
+    pool.parallelFor(chunks, [&](int chunk) {
+        int begin = detail::chunkBegin(A.cols(), chunks, chunk);
+        int end = detail::chunkBegin(A.cols(), chunks, chunk + 1);
+        std::vector<size_t> out(result.colPtr.begin() + begin, result.colPtr.begin() + end);
+        for (int i = 0; i < A.rows(); i++) {
+            const T* a = A.row(i);
+            for (int j = begin; j < end; j++) {
+                if (a[j] != T()) {
+                    result.rowIndex[out[j - begin]] = i;
+                    result.values[out[j - begin]] = a[j];
+                    out[j - begin]++;
+                }
+            }
+        }
+    });
+    return result;
+}
+
+template<class T>
+Matrix<T> toDense(const CsrMatrix<T>& A) {
+    Matrix<T> result(A.rows, A.cols);
+    for (int i = 0; i < A.rows; i++) {
+        T* r = result.row(i);
+        for (size_t p = A.rowPtr[i]; p < A.rowPtr[i + 1]; p++) {
+            r[A.colIndex[p]] = A.values[p];
+        }
+    }
+    return result;
+}
+
+// C = A (CSR) * B (плотная), параллельно по полосам строк.
+// Каждый ненулевой A(i, k) добавляет к строке C(i, :) строку B(k, :), умноженную на него;
+// внутренний цикл идёт подряд по памяти и векторизуется компилятором.
+template<class T, class Acc>
+void csrTimesDense(const CsrMatrix<T>& A, MatrixView<const T> B, MatrixView<Acc> C, ThreadPool& pool) {
+    const int chunks = detail::chunkCount(A.rows, pool);
+    pool.parallelFor(chunks, [&](int chunk) {
+        for (int i = detail::chunkBegin(A.rows, chunks, chunk);
+             i < detail::chunkBegin(A.rows, chunks, chunk + 1); i++) {
+            Acc* c = C.row(i);
+            std::fill(c, c + C.cols(), Acc());
+            for (size_t p = A.rowPtr[i]; p < A.rowPtr[i + 1]; p++) {
+                const Acc a = static_cast<Acc>(A.values[p]);
+                const T* b = B.row(A.colIndex[p]);
+                for (int j = 0; j < C.cols(); j++) {
+                    c[j] += a * static_cast<Acc>(b[j]);
+                }
+            }
+        }
+    });
+}
+
+// C = A (плотная) * B (CSC): C(i, j) — скалярное произведение строки A
+// на ненулевые столбца j; параллельно по полосам строк
+template<class T, class Acc>
+void denseTimesCsc(MatrixView<const T> A, const CscMatrix<T>& B, MatrixView<Acc> C, ThreadPool& pool) {
+    const int chunks = detail::chunkCount(A.rows(), pool);
+    pool.parallelFor(chunks, [&](int chunk) {
+        for (int i = detail::chunkBegin(A.rows(), chunks, chunk);
+             i < detail::chunkBegin(A.rows(), chunks, chunk + 1); i++) {
+            const T* a = A.row(i);
+            Acc* c = C.row(i);
+            for (int j = 0; j < B.cols; j++) {
+                Acc sum = Acc();
+                for (size_t p = B.colPtr[j]; p < B.colPtr[j + 1]; p++) {
+                    sum += static_cast<Acc>(a[B.rowIndex[p]]) * static_cast<Acc>(B.values[p]);
+                }
+                c[j] = sum;
+            }
+        }
+    });
+}
+
+// Плотный аккумулятор строки занимает B.cols элементов на поток; при более широких
+// матрицах используется хеш-таблица по затронутым столбцам
+const int kDenseAccumulatorLimit = 1 << 22;
+
+// C = A (CSR) * B (CSR) по Густавсону: строка C(i, :) собирается из строк B(k, :)
+// для ненулевых A(i, k) в аккумуляторе своей части строк. Части считаются параллельно,
+// затем их результаты копируются в итоговую CSR по префиксным суммам.
+template<class T, class Acc>
+CsrMatrix<Acc> csrTimesCsr(const CsrMatrix<T>& A, const CsrMatrix<T>& B, ThreadPool& pool) {
+    const int chunks = detail::chunkCount(A.rows, pool);
+    std::vector<std::vector<int>> chunkCols(chunks);
+    std::vector<std::vector<Acc>> chunkValues(chunks);
+
+    CsrMatrix<Acc> result;
+    result.rows = A.rows;
+    result.cols = B.cols;
+    result.rowPtr.assign(A.rows + 1, 0);
+
+    pool.parallelFor(chunks, [&](int chunk) {
+        std::vector<int>& cols = chunkCols[chunk];
+        std::vector<Acc>& values = chunkValues[chunk];
+        std::vector<int> touched;
+        const bool dense = B.cols <= kDenseAccumulatorLimit;
+        std::vector<Acc> accumulator(dense ? B.cols : 0, Acc());
+        std::vector<char> used(dense ? B.cols : 0, 0);
+        std::unordered_map<int, Acc> hashed;
+
+        for (int i = detail::chunkBegin(A.rows, chunks, chunk);
+             i < detail::chunkBegin(A.rows, chunks, chunk + 1); i++) {
+            touched.clear();
+            for (size_t p = A.rowPtr[i]; p < A.rowPtr[i + 1]; p++) {
+                const Acc a = static_cast<Acc>(A.values[p]);
+                const int k = A.colIndex[p];
+                for (size_t q = B.rowPtr[k]; q < B.rowPtr[k + 1]; q++) {
+                    const int j = B.colIndex[q];
+                    const Acc product = a * static_cast<Acc>(B.values[q]);
+                    if (dense) {
+                        if (!used[j]) {
+                            used[j] = 1;
+                            touched.push_back(j);
+                        }
+                        accumulator[j] += product;
+                    } else {
+                        auto inserted = hashed.emplace(j, Acc());
+                        if (inserted.second) {
+                            touched.push_back(j);
+                        }
+                        inserted.first->second += product;
+                    }
+                }
+            }
+            std::sort(touched.begin(), touched.end());
+            for (int j : touched) {
+                cols.push_back(j);
+                if (dense) {
+                    values.push_back(accumulator[j]);
+                    accumulator[j] = Acc();
+                    used[j] = 0;
+                } else {
+                    values.push_back(hashed[j]);
+                }
+            }
+            hashed.clear();
+            result.rowPtr[i] = touched.size();
+        }
+    });
+
+    size_t nnz = sparse_detail::exclusiveScan(result.rowPtr);
+    result.colIndex.resize(nnz);
+    result.values.resize(nnz);
+    pool.parallelFor(chunks, [&](int chunk) {
+        size_t out = result.rowPtr[detail::chunkBegin(A.rows, chunks, chunk)];
+        std::copy(chunkCols[chunk].begin(), chunkCols[chunk].end(), result.colIndex.begin() + out);
+        std::copy(chunkValues[chunk].begin(), chunkValues[chunk].end(), result.values.begin() + out);
+    });
+    return result;
+}
+
+#endif // SPARSE_H_
@@ -0,0 +1,174 @@
+#ifndef STRASSEN_H_
+#define STRASSEN_H_
+
+#include <algorithm>
+#include "matrix.h"
+#include "thread_pool.h"
+
+// Параметры рекурсии Штрассена–Винограда
+struct StrassenOptions {
+    int cutoff;         // при min(M, K, N) <= cutoff работает базовое ядро
+    int parallelLevels; // сколько верхних уровней считают 7 произведений параллельно
+};
+
+namespace strassen_detail {
+
+template<class T>
+void add(MatrixView<const T> X, MatrixView<const T> Y, MatrixView<T> Z) {
+    for (int i = 0; i < Z.rows(); i++) {
+        const T* x = X.row(i);
+        const T* y = Y.row(i);
+        T* z = Z.row(i);
+        for (int j = 0; j < Z.cols(); j++) {
+            z[j] = x[j] + y[j];
+        }
+    }
+}
+
+template<class T>
+void sub(MatrixView<const T> X, MatrixView<const T> Y, MatrixView<T> Z) {
+    for (int i = 0; i < Z.rows(); i++) {
+        const T* x = X.row(i);
+        const T* y = Y.row(i);
+        T* z = Z.row(i);
+        for (int j = 0; j < Z.cols(); j++) {
+            z[j] = x[j] - y[j];
+        }
+    }
+}
+
+// Досчёт «отщеплённых» нечётных строки/столбца после рекурсии по чётной части:
+// M, K, N — полные размеры, чётная часть уже записана в C[0:M&~1, 0:N&~1]
+template<class T>
+void peelFixup(MatrixView<const T> A, MatrixView<const T> B, MatrixView<T> C) {
+    const int M = C.rows();
+    const int N = C.cols();
+    const int K = A.cols();
+    const int Me = M & ~1;
+    const int Ke = K & ~1;
+    const int Ne = N & ~1;
+
+    // Ранг-1 поправка от последнего столбца A и последней строки B
+    if (K != Ke) {
+        const T* brow = B.row(K - 1);
+        for (int i = 0; i < Me; i++) {
+            T a = A(i, K - 1);
+            T* c = C.row(i);
+            for (int j = 0; j < Ne; j++) {
+                c[j] += a * brow[j];
+            }
+        }
+    }
+    // Последний столбец C для чётных строк
+    if (N != Ne) {
+        for (int i = 0; i < Me; i++) {
+            const T* a = A.row(i);
+            T sum = T();
+            for (int k = 0; k < K; k++) {
+                sum += a[k] * B(k, N - 1);
+            }
+            C(i, N - 1) = sum;
+        }
+    }
+    // Последняя строка C целиком
+    if (M != Me) {
+        const T* a = A.row(M - 1);
+        T* c = C.row(M - 1);
+        std::fill(c, c + N, T());
+        for (int k = 0; k < K; k++) {
+            const T* brow = B.row(k);
+            for (int j = 0; j < N; j++) {
+                c[j] += a[k] * brow[j];
+            }
+        }
+    }
+}
+
+} // namespace strassen_detail
+
+// C = A * B по схеме Винограда (7 умножений, 15 сложений на уровень).
+// Нечётные размеры обрабатываются динамическим отщеплением последней строки/столбца,
+// поэтому дополнение до степени двойки не требуется.
+// base(A, B, C) должна записать A * B в C (C не обнулена).
+template<class T, class BaseMultiply>
+void strassenWinograd(MatrixView<const T> A, MatrixView<const T> B, MatrixView<T> C,
+    const StrassenOptions& options, ThreadPool& pool, BaseMultiply& base, int level = 0) {
+    using namespace strassen_detail;
+    const int M = C.rows();
+    const int N = C.cols();
+    const int K = A.cols();
+    const int cutoff = std::max(options.cutoff, 2);
+
+    if (M <= cutoff || K <= cutoff || N <= cutoff) {
+        base(A, B, C);
+        return;
+    }
+
+    const int m = M / 2;
+    const int k = K / 2;
+    const int n = N / 2;
+
+    MatrixView<const T> A11 = A.tile(0, 0, m, k), A12 = A.tile(0, k, m, k);
+    MatrixView<const T> A21 = A.tile(m, 0, m, k), A22 = A.tile(m, k, m, k);
+    MatrixView<const T> B11 = B.tile(0, 0, k, n), B12 = B.tile(0, n, k, n);
+    MatrixView<const T> B21 = B.tile(k, 0, k, n), B22 = B.tile(k, n, k, n);
+
+    Matrix<T> S1(m, k), S2(m, k), S3(m, k), S4(m, k);
+    Matrix<T> T1(k, n), T2(k, n), T3(k, n), T4(k, n);
+    add<T>(A21, A22, S1.view());
+    sub<T>(S1.view(), A11, S2.view());
+    sub<T>(A11, A21, S3.view());
+    sub<T>(A12, S2.view(), S4.view());
+    sub<T>(B12, B11, T1.view());
+    sub<T>(B22, T1.view(), T2.view());
+    sub<T>(B22, B12, T3.view());
+    sub<T>(T2.view(), B21, T4.view());
+
+    Matrix<T> P[7];
+    for (int p = 0; p < 7; p++) {
+        P[p] = Matrix<T>(m, n);
+    }
+    MatrixView<const T> left[7] = { A11, A12, S4.view(), A22, S1.view(), S2.view(), S3.view() };
+    MatrixView<const T> right[7] = { B11, B21, B22, T4.view(), T1.view(), T2.view(), T3.view() };
+
+    auto product = [&](int p) {
+        strassenWinograd<T>(left[p], right[p], P[p].view(), options, pool, base, level + 1);
+    };
+    if (level < options.parallelLevels) {
+        pool.parallelFor(7, product);
+    } else {
+        for (int p = 0; p < 7; p++) {
+            product(p);
+        }
+    }
+
+    // U2 = P1 + P6, U3 = U2 + P7, U4 = U2 + P5
+    MatrixView<T> C11 = C.tile(0, 0, m, n), C12 = C.tile(0, n, m, n);
+    MatrixView<T> C21 = C.tile(m, 0, m, n), C22 = C.tile(m, n, m, n);
+    for (int i = 0; i < m; i++) {
+        const T* p1 = P[0].row(i);
+        const T* p2 = P[1].row(i);
+        const T* p3 = P[2].row(i);
+        const T* p4 = P[3].row(i);
+        const T* p5 = P[4].row(i);
+        const T* p6 = P[5].row(i);
+        const T* p7 = P[6].row(i);
+        T* c11 = C11.row(i);
+        T* c12 = C12.row(i);
+        T* c21 = C21.row(i);
+        T* c22 = C22.row(i);
+        for (int j = 0; j < n; j++) {
+            T u2 = p1[j] + p6[j];
+            T u3 = u2 + p7[j];
+            T u4 = u2 + p5[j];
+            c11[j] = p1[j] + p2[j];
+            c12[j] = u4 + p3[j];
+            c21[j] = u3 - p4[j];
+            c22[j] = u3 + p5[j];
+        }
+    }
+
+    peelFixup<T>(A, B, C);
+}
+
+#endif // STRASSEN_H_
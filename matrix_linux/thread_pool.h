@@ -0,0 +1,227 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Постоянный пул рабочих потоков.
+// Потоки создаются один раз в конструкторе и переиспользуются всеми вызовами,
+// поэтому стоимость pthread_create не ложится на каждое умножение.
+class ThreadPool {
+public:
+    // threads <= 0 означает hardware_concurrency()
+    explicit ThreadPool(int threads = 0) : stop_(false), head_(0), count_(0) {
+        if (threads <= 0) {
+            threads = static_cast<int>(std::thread::hardware_concurrency());
+        }
+        if (threads <= 0) {
+            threads = 1;
+        }
+        queue_.resize(64);
+        workers_.reserve(threads);
+        for (int i = 0; i < threads; i++) {
+            workers_.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        taskCv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers_.size()); }
+
+    // Общий пул процесса, размер hardware_concurrency()
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // Поставить независимую задачу в очередь. Исключение задачи перехватывается,
+    // чтобы не завершить рабочий поток, и теряется: задачи, чей результат нужен,
+    // передают ошибку сами (как submitAsync)
+    void submit(std::function<void()> task) {
+        std::function<void()>* heapTask = new std::function<void()>(std::move(task));
+        push(Task{ &runFunction, heapTask, nullptr });
+    }
+
+    // Выполнить fn(index) для index в [0, count).
+    // Индексы раздаются через атомарный счётчик: вызывающий поток работает наравне
+    // с рабочими, поэтому вложенные вызовы из задач пула не блокируются.
+    // Не выделяет память в куче. Первое исключение из fn останавливает раздачу
+    // индексов и перебрасывается вызывающему после остановки всех помощников.
+    template<class F>
+    void parallelFor(int count, F&& fn) {
+        if (count <= 0) {
+            return;
+        }
+        typedef typename std::remove_reference<F>::type Body;
+        ForJob job;
+        job.body = [](void* ctx, int index) { (*static_cast<Body*>(ctx))(index); };
+        job.ctx = const_cast<void*>(static_cast<const void*>(&fn));
+        job.count = count;
+        job.next.store(0, std::memory_order_relaxed);
+        job.active = 0;
+        job.failed.store(false, std::memory_order_relaxed);
+
+        int helpers = std::min(count - 1, size());
+        if (helpers > 0) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (int i = 0; i < helpers; i++) {
+                pushLocked(Task{ &runForHelper, &job, &job });
+            }
+        }
+        if (helpers == 1) {
+            taskCv_.notify_one();
+        } else if (helpers > 1) {
+            taskCv_.notify_all();
+        }
+
+        runForLoop(job);
+
+        // Снимаем помощников, которые так и не начали работу, и ждём запущенных
+        std::unique_lock<std::mutex> lock(mutex_);
+        removeJobLocked(&job);
+        doneCv_.wait(lock, [&job]() { return job.active == 0; });
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    struct ForJob {
+        void (*body)(void* ctx, int index);
+        void* ctx;
+        int count;
+        std::atomic<int> next;
+        int active; // число запущенных помощников, под mutex_
+        std::atomic<bool> failed;
+        std::mutex errorMutex;
+        std::exception_ptr error; // первое исключение fn, под errorMutex
+    };
+
+    struct Task {
+        void (*run)(void* arg);
+        void* arg;
+        ForJob* job; // не nullptr для помощников parallelFor
+    };
+
+    static void runFunction(void* arg) {
+        std::unique_ptr<std::function<void()>> task(static_cast<std::function<void()>*>(arg));
+        try {
+            (*task)();
+        } catch (...) {
+        }
+    }
+
+    // Исключения не покидают цикл: стек вызывающего потока с job нельзя раскручивать,
+    // пока помощники держат на него указатель, а исключение помощника завершило бы процесс
+    static void runForLoop(ForJob& job) {
+        while (!job.failed.load(std::memory_order_relaxed)) {
+            int index = job.next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= job.count) {
+                break;
+            }
+            try {
+                job.body(job.ctx, index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.errorMutex);
+                if (!job.error) {
+                    job.error = std::current_exception();
+                }
+                job.failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static void runForHelper(void* arg) {
+        runForLoop(*static_cast<ForJob*>(arg));
+    }
+
+    void push(const Task& task) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            pushLocked(task);
+        }
+        taskCv_.notify_one();
+    }
+
+    // Кольцевой буфер задач; растёт удвоением и никогда не сжимается
+    void pushLocked(const Task& task) {
+        if (count_ == queue_.size()) {
+            std::vector<Task> grown(queue_.size() * 2);
+            for (size_t i = 0; i < count_; i++) {
+                grown[i] = queue_[(head_ + i) % queue_.size()];
+            }
+            queue_.swap(grown);
+            head_ = 0;
+        }
+        queue_[(head_ + count_) % queue_.size()] = task;
+        count_++;
+    }
+
+    void removeJobLocked(ForJob* job) {
+        size_t kept = 0;
+        for (size_t i = 0; i < count_; i++) {
+            const Task& task = queue_[(head_ + i) % queue_.size()];
+            if (task.job != job) {
+                queue_[(head_ + kept) % queue_.size()] = task;
+                kept++;
+            }
+        }
+        count_ = kept;
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            taskCv_.wait(lock, [this]() { return stop_ || count_ > 0; });
+            if (count_ == 0) {
+                return; // stop_ и очередь пуста
+            }
+            Task task = queue_[head_];
+            head_ = (head_ + 1) % queue_.size();
+            count_--;
+            if (task.job) {
+                task.job->active++;
+            }
+            lock.unlock();
+
+            task.run(task.arg);
+
+            lock.lock();
+            if (task.job && --task.job->active == 0) {
+                doneCv_.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::vector<Task> queue_;
+    bool stop_;
+    size_t head_;
+    size_t count_;
+
+    std::mutex mutex_;
+    std::condition_variable taskCv_;
+    std::condition_variable doneCv_;
+};
+
+#endif // THREAD_POOL_H_
@@ -0,0 +1,239 @@
+#ifndef VERIFY_H_
+#define VERIFY_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "cpu_features.h"
+#include "detail.h"
+#include "matrix.h"
+#include "thread_pool.h"
+
+// Проверка результата умножения без пересчёта за O(M*K*N)
+enum class VerifyMode {
+    Reference, // полный последовательный пересчёт и сравнение в одном потоке
+    Exact,     // полный пересчёт и параллельное поэлементное сравнение
+    Freivalds  // вероятностная проверка Фрейвалдса за O(t * (M*K + K*N + M*N))
+};
+
+namespace verify_detail {
+
+// Тип проверки: для целых — беззнаковый того же размера, чтобы переполнение
+// давало то же кольцо вычетов по модулю 2^w, что и само умножение; для вещественных — double
+template<class Acc, bool = std::is_integral<Acc>::value>
+struct CheckType { typedef typename std::make_unsigned<Acc>::type type; };
+
+template<class Acc>
+struct CheckType<Acc, false> { typedef double type; };
+
+} // namespace verify_detail
+
+// Испытания идут группами с постоянной длиной цикла, которую компилятор векторизует
+const int kFreivaldsGroup = 32;
+
+// Число испытаний для вероятности ложного принятия не выше p.
+// Вектор r берётся из {0,1}^N: если C != A*B, то для ненулевого d_ij матрицы A*B - C
+// смена r_j меняет (A*B - C)r в строке i на d_ij, поэтому хотя бы одно из двух значений
+// r_j обнаруживает ошибку и одно испытание пропускает её с вероятностью не выше 1/2.
+// Нужные log2(1/p) испытаний округляются вверх до kFreivaldsGroup: лишние
+// испытания почти ничего не стоят и только уменьшают вероятность.
+inline int freivaldsTrials(double falseAcceptProbability) {
+    if (!(falseAcceptProbability > 0.0 && falseAcceptProbability < 1.0)) {
+        throw std::invalid_argument("freivaldsTrials: probability must be in (0, 1)");
+    }
+    int needed = std::max(1, static_cast<int>(std::ceil(-std::log2(falseAcceptProbability))));
+    return (needed + kFreivaldsGroup - 1) / kFreivaldsGroup * kFreivaldsGroup;
+}
+
+// out[0..t) = сумма по j значений x[j] (по модулю при Abs), умноженных на строки
+// rows[j*t..j*t+t). Длина внутреннего цикла постоянна, поэтому он векторизуется;
+// пропуск нулей ускоряет проверку разреженных операндов.
+template<class X, class W, bool Abs>
+__attribute__((always_inline)) inline void combineRowsBody(const X* x, int n, const W* __restrict rows, int t, W* __restrict out) {
+    std::fill(out, out + t, W());
+    for (int j = 0; j < n; j++) {
+        W v = static_cast<W>(x[j]);
+        if constexpr (Abs) {
+            v = std::fabs(v);
+        }
+        if (v == W()) {
+            continue;
+        }
+        const W* in = rows + static_cast<size_t>(j) * t;
+        for (int g = 0; g < t; g += kFreivaldsGroup) {
+            for (int s = 0; s < kFreivaldsGroup; s++) {
+                out[g + s] += v * in[g + s];
+            }
+        }
+    }
+}
+
+template<class X, class W, bool Abs>
+void combineRows(const X* x, int n, const W* rows, int t, W* out) {
+    combineRowsBody<X, W, Abs>(x, n, rows, t, out);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+template<class X, class W, bool Abs>
+__attribute__((target("avx2")))
+void combineRowsAvx2(const X* x, int n, const W* rows, int t, W* out) {
+    combineRowsBody<X, W, Abs>(x, n, rows, t, out);
+}
+
+template<class X, class W, bool Abs>
+__attribute__((target("avx512f,avx512bw,avx512dq")))
+void combineRowsAvx512(const X* x, int n, const W* rows, int t, W* out) {
+    combineRowsBody<X, W, Abs>(x, n, rows, t, out);
+}
+#endif
+
+template<class X, class W, bool Abs>
+using CombineRowsKernel = void (*)(const X* x, int n, const W* rows, int t, W* out);
+
+// Самый широкий набор инструкций процессора: без него 32- и 64-битные
+// умножения целых на SSE2 собираются из нескольких инструкций
+template<class X, class W, bool Abs>
+CombineRowsKernel<X, W, Abs> selectCombineRows() {
+#if defined(__x86_64__) || defined(__i386__)
+    const CpuFeatures& cpu = CpuFeatures::detect();
+    if (cpu.avx512f && cpu.avx512bw && cpu.avx512dq) {
+        return &combineRowsAvx512<X, W, Abs>;
+    }
+    if (cpu.avx2) {
+        return &combineRowsAvx2<X, W, Abs>;
+    }
+#endif
+    return &combineRows<X, W, Abs>;
+}
+
+// Проверка Фрейвалдса: все t испытаний выполняются одним проходом по каждой матрице,
+// векторы r_1..r_t образуют матрицу R (N x t). Считаются B*R, A*(B*R) и C*R
+// параллельно по полосам строк. Для целых проверка точная (по модулю 2^w),
+// для вещественных — с допуском relTol от |A|*(|B|*R), где relTol по умолчанию
+// растёт с K, как в areMatricesClose (суммы с R считаются в double). Ошибки меньше
+// этого допуска вещественная проверка не различает.
+// Биты R зависят только от seed и номера столбца, а не от числа потоков.
+template<class T, class Acc>
+bool freivaldsCheck(MatrixView<const T> A, MatrixView<const T> B, MatrixView<const Acc> C,
+    double falseAcceptProbability, ThreadPool& pool, uint64_t seed, double relTol = -1.0) {
+    typedef typename verify_detail::CheckType<Acc>::type W;
+    constexpr bool floating = std::is_floating_point<Acc>::value;
+    const int M = A.rows();
+    const int K = A.cols();
+    const int N = B.cols();
+    if (B.rows() != K || C.rows() != M || C.cols() != N) {
+        throw std::invalid_argument("freivaldsCheck: operand shapes do not match");
+    }
+    const int t = freivaldsTrials(falseAcceptProbability);
+    if (relTol < 0.0) {
+        relTol = 4.0 * std::max(K, 1) * std::numeric_limits<Acc>::epsilon();
+    }
+    const CombineRowsKernel<T, W, false> combineT = selectCombineRows<T, W, false>();
+    // |x| нужен только вещественным; у целых это то же ядро, что combineT
+    const CombineRowsKernel<T, W, floating> combineAbs = selectCombineRows<T, W, floating>();
+    const CombineRowsKernel<Acc, W, false> combineC = selectCombineRows<Acc, W, false>();
+
+    // R (N x t): бит s столбца j — из splitMix64 по seed, j и номеру слова
+    const int words = (t + 63) / 64;
+    std::vector<W> R(static_cast<size_t>(N) * t);
+    for (int j = 0; j < N; j++) {
+        for (int w = 0; w < words; w++) {
+            uint64_t bits = detail::splitMix64(seed ^ detail::splitMix64(
+                static_cast<uint64_t>(j) * words + w));
+            for (int s = w * 64; s < std::min(t, w * 64 + 64); s++) {
+                R[static_cast<size_t>(j) * t + s] = static_cast<W>((bits >> (s - w * 64)) & 1);
+            }
+        }
+    }
+
+    // BR (K x t) = B * R; для вещественных ещё |B| * R — масштаб допуска
+    std::vector<W> BR(static_cast<size_t>(K) * t);
+    std::vector<W> BRabs(floating ? BR.size() : 0);
+    int chunks = detail::chunkCount(K, pool);
+    pool.parallelFor(chunks, [&](int chunk) {
+        for (int k = detail::chunkBegin(K, chunks, chunk);
+             k < detail::chunkBegin(K, chunks, chunk + 1); k++) {
+            combineT(B.row(k), N, R.data(), t, &BR[static_cast<size_t>(k) * t]);
+            if constexpr (floating) {
+                combineAbs(B.row(k), N, R.data(), t, &BRabs[static_cast<size_t>(k) * t]);
+            }
+        }
+    });
+
+    // A * BR и C * R по строкам, сравнение сразу после подсчёта строки
+    std::atomic<bool> mismatch(false);
+    chunks = detail::chunkCount(M, pool);
+    pool.parallelFor(chunks, [&](int chunk) {
+        std::vector<W> left(t);
+        std::vector<W> right(t);
+        std::vector<W> scale(floating ? t : 0);
+        for (int i = detail::chunkBegin(M, chunks, chunk);
+             i < detail::chunkBegin(M, chunks, chunk + 1); i++) {
+            if (mismatch.load(std::memory_order_relaxed)) {
+                return;
+            }
+            combineT(A.row(i), K, BR.data(), t, left.data());
+            combineC(C.row(i), N, R.data(), t, right.data());
+            if constexpr (floating) {
+                combineAbs(A.row(i), K, BRabs.data(), t, scale.data());
+            }
+            for (int s = 0; s < t; s++) {
+                bool equal;
+                if constexpr (floating) {
+                    equal = std::fabs(left[s] - right[s]) <= relTol * scale[s];
+                } else {
+                    equal = left[s] == right[s];
+                }
+                if (!equal) {
+                    mismatch.store(true, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+    });
+    return !mismatch.load();
+}
+
+// Параллельное сравнение: точное для целых, для вещественных
+// |x - y| <= relTol * max(|x|, |y|) + absTol
+template<class U>
+bool matricesMatchParallel(MatrixView<const U> X, MatrixView<const U> Y, ThreadPool& pool,
+    double relTol = 0.0, double absTol = 0.0) {
+    if (X.rows() != Y.rows() || X.cols() != Y.cols()) {
+        return false;
+    }
+    std::atomic<bool> mismatch(false);
+    const int chunks = detail::chunkCount(X.rows(), pool);
+    pool.parallelFor(chunks, [&](int chunk) {
+        for (int i = detail::chunkBegin(X.rows(), chunks, chunk);
+             i < detail::chunkBegin(X.rows(), chunks, chunk + 1); i++) {
+            if (mismatch.load(std::memory_order_relaxed)) {
+                return;
+            }
+            const U* x = X.row(i);
+            const U* y = Y.row(i);
+            bool equal = true;
+            if constexpr (std::is_floating_point<U>::value) {
+                for (int j = 0; j < X.cols(); j++) {
+                    double a = static_cast<double>(x[j]);
+                    double b = static_cast<double>(y[j]);
+                    equal &= std::fabs(a - b) <= relTol * std::max(std::fabs(a), std::fabs(b)) + absTol;
+                }
+            } else {
+                equal = std::equal(x, x + X.cols(), y);
+            }
+            if (!equal) {
+                mismatch.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    });
+    return !mismatch.load();
+}
+
+#endif // VERIFY_H_
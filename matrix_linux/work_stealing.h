@@ -0,0 +1,349 @@
+#ifndef WORK_STEALING_H_
+#define WORK_STEALING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Прямоугольная область выхода [startRow, endRow) x [startCol, endCol)
+struct StealTile {
+    int startRow;
+    int endRow;
+    int startCol;
+    int endCol;
+
+    long long area() const {
+        return static_cast<long long>(endRow - startRow) * (endCol - startCol);
+    }
+};
+
+// Статистика одного рабочего за запуск
+struct WorkerStats {
+    int tiles;       // выполнено листовых плиток
+    int steals;      // успешных краж
+    double busyUs;   // время внутри плиток
+    double finishUs; // момент завершения последней плитки от начала запуска
+};
+
+// Статистика запуска: по рабочим и хвост — разброс моментов завершения
+struct StealingStats {
+    std::vector<WorkerStats> workers;
+    double totalUs;
+
+    // Сколько самый ранний рабочий простаивал в ожидании самого позднего
+    double tailUs() const {
+        double first = totalUs;
+        double last = 0.0;
+        for (const WorkerStats& w : workers) {
+            if (w.tiles == 0) {
+                continue;
+            }
+            first = std::min(first, w.finishUs);
+            last = std::max(last, w.finishUs);
+        }
+        return last > first ? last - first : 0.0;
+    }
+
+    int steals() const {
+        int total = 0;
+        for (const WorkerStats& w : workers) {
+            total += w.steals;
+        }
+        return total;
+    }
+};
+
+// Планировщик с кражей работы: у каждого рабочего своя дека плиток.
+// Владелец берёт плитки снизу (LIFO) и рекурсивно делит крупные пополам,
+// откладывая вторую половину; простаивающие рабочие крадут сверху (FIFO) у
+// случайной жертвы, забирая самые крупные отложенные куски. Рабочий, которому
+// нечего украсть, после нескольких попыток засыпает до появления новых плиток.
+// Вызывающий поток участвует как рабочий 0. Первое исключение из плитки
+// останавливает запуск и перебрасывается из run().
+class WorkStealingScheduler {
+public:
+    // threads <= 0 означает hardware_concurrency()
+    explicit WorkStealingScheduler(int threads = 0)
+        : body_(nullptr), grainRows_(1), grainCols_(1), queued_(0), sleepers_(0), failed_(false),
+          epoch_(0), active_(0), stop_(false) {
+        if (threads <= 0) {
+            threads = static_cast<int>(std::thread::hardware_concurrency());
+        }
+        threads = std::max(threads, 1);
+        queues_ = std::vector<WorkerQueue>(threads);
+        stats_.workers.resize(threads);
+        for (int i = 1; i < threads; i++) {
+            threads_.emplace_back([this, i]() { threadLoop(i); });
+        }
+    }
+
+    ~WorkStealingScheduler() {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        startCv_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+    int size() const { return static_cast<int>(queues_.size()); }
+
+    // Обойти область rows x cols листовыми плитками не больше grainRows x grainCols.
+    // Границы плиток кратны grainRows/grainCols.
+    StealingStats run(int rows, int cols, int grainRows, int grainCols,
+        const std::function<void(const StealTile&)>& body) {
+        if (rows <= 0 || cols <= 0) {
+            return StealingStats{ std::vector<WorkerStats>(size(), WorkerStats()), 0.0 };
+        }
+        body_ = &body;
+        grainRows_ = std::max(grainRows, 1);
+        grainCols_ = std::max(grainCols, 1);
+        remaining_.store(static_cast<long long>(rows) * cols);
+        failed_.store(false);
+        error_ = nullptr;
+        for (WorkerStats& w : stats_.workers) {
+            w = WorkerStats();
+        }
+        pushOwn(0, StealTile{ 0, rows, 0, cols });
+        start_ = std::chrono::steady_clock::now();
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            epoch_++;
+            active_ = size() - 1;
+        }
+        startCv_.notify_all();
+
+        workerLoop(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCv_.wait(lock, [this]() { return active_ == 0; });
+        stats_.totalUs = elapsedUs();
+        body_ = nullptr;
+        if (error_) {
+            // Остановленный запуск оставляет в деках неразобранные плитки
+            for (WorkerQueue& queue : queues_) {
+                queue.tiles.clear();
+            }
+            queued_.store(0);
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+        return stats_;
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<StealTile> tiles;
+
+        WorkerQueue() {}
+        WorkerQueue(const WorkerQueue&) {}
+        WorkerQueue& operator=(const WorkerQueue&) { return *this; }
+    };
+
+    double elapsedUs() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+    void threadLoop(int id) {
+        unsigned long long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                startCv_.wait(lock, [&]() { return stop_ || epoch_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = epoch_;
+            }
+            workerLoop(id);
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (--active_ == 0) {
+                    doneCv_.notify_all();
+                }
+            }
+        }
+    }
+
+    bool popOwn(int id, StealTile& tile) {
+        WorkerQueue& queue = queues_[id];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tiles.empty()) {
+            return false;
+        }
+        tile = queue.tiles.back();
+        queue.tiles.pop_back();
+        queued_.fetch_sub(1);
+        return true;
+    }
+
+    void pushOwn(int id, const StealTile& tile) {
+        {
+            WorkerQueue& queue = queues_[id];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tiles.push_back(tile);
+        }
+        queued_.fetch_add(1);
+        wakeIdle(false);
+    }
+
+    // Будит спящих рабочих: одного на новую плитку, всех — по окончании запуска.
+    // Пустая критическая секция не даёт потерять сигнал между проверкой и wait.
+    void wakeIdle(bool all) {
+        if (sleepers_.load() == 0) {
+            return;
+        }
+        { std::lock_guard<std::mutex> lock(idleMutex_); }
+        if (all) {
+            idleCv_.notify_all();
+        } else {
+            idleCv_.notify_one();
+        }
+    }
+
+    bool finished() const {
+        return remaining_.load() <= 0 || failed_.load();
+    }
+
+    // Сон до появления плиток в деках или конца запуска
+    void waitForWork() {
+        std::unique_lock<std::mutex> lock(idleMutex_);
+        sleepers_.fetch_add(1);
+        idleCv_.wait(lock, [this]() { return queued_.load() > 0 || finished(); });
+        sleepers_.fetch_sub(1);
+    }
+
+    bool steal(int id, unsigned int& seed, StealTile& tile) {
+        const int n = size();
+        // xorshift: разные рабочие обходят жертв в разном порядке
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        int first = static_cast<int>(seed % n);
+        for (int i = 0; i < n; i++) {
+            int victim = (first + i) % n;
+            if (victim == id) {
+                continue;
+            }
+            WorkerQueue& queue = queues_[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tiles.empty()) {
+                tile = queue.tiles.front();
+                queue.tiles.pop_front();
+                queued_.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Делит плитку пополам по измерению, где больше зёрен; false — плитка уже листовая
+    bool split(StealTile& tile, StealTile& rest) const {
+        int rowGrains = (tile.endRow - tile.startRow + grainRows_ - 1) / grainRows_;
+        int colGrains = (tile.endCol - tile.startCol + grainCols_ - 1) / grainCols_;
+        if (rowGrains <= 1 && colGrains <= 1) {
+            return false;
+        }
+        rest = tile;
+        if (rowGrains >= colGrains) {
+            int mid = tile.startRow + (rowGrains / 2) * grainRows_;
+            tile.endRow = mid;
+            rest.startRow = mid;
+        } else {
+            int mid = tile.startCol + (colGrains / 2) * grainCols_;
+            tile.endCol = mid;
+            rest.startCol = mid;
+        }
+        return true;
+    }
+
+    void workerLoop(int id) {
+        // Неудачных краж подряд до сна: короткие промежутки без плиток переживаются без засыпания
+        const int spinRounds = 16;
+        WorkerStats& stats = stats_.workers[id];
+        unsigned int seed = 0x9e3779b9u * (id + 1);
+        int idle = 0;
+        while (!finished()) {
+            StealTile tile;
+            if (!popOwn(id, tile)) {
+                if (!steal(id, seed, tile)) {
+                    if (++idle < spinRounds) {
+                        std::this_thread::yield();
+                    } else {
+                        waitForWork();
+                        idle = 0;
+                    }
+                    continue;
+                }
+                stats.steals++;
+            }
+            idle = 0;
+            StealTile rest;
+            while (split(tile, rest)) {
+                pushOwn(id, rest);
+            }
+            double begin = elapsedUs();
+            try {
+                (*body_)(tile);
+            } catch (...) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!error_) {
+                        error_ = std::current_exception();
+                    }
+                }
+                failed_.store(true);
+                wakeIdle(true);
+                return;
+            }
+            double end = elapsedUs();
+            stats.tiles++;
+            stats.busyUs += end - begin;
+            stats.finishUs = end;
+            if (remaining_.fetch_sub(tile.area()) == tile.area()) {
+                wakeIdle(true);
+            }
+        }
+    }
+
+    std::vector<WorkerQueue> queues_;
+    std::vector<std::thread> threads_;
+    StealingStats stats_;
+
+    const std::function<void(const StealTile&)>* body_;
+    int grainRows_;
+    int grainCols_;
+    std::atomic<long long> remaining_;
+    std::atomic<long long> queued_;   // плиток во всех деках
+    std::atomic<int> sleepers_;       // рабочих в waitForWork
+    std::atomic<bool> failed_;        // плитка бросила исключение, запуск остановлен
+    std::exception_ptr error_;        // первое исключение запуска, под mutex_
+    std::chrono::steady_clock::time_point start_;
+
+    std::mutex idleMutex_;
+    std::condition_variable idleCv_;
+
+    std::mutex mutex_;
+    std::condition_variable startCv_;
+    std::condition_variable doneCv_;
+    unsigned long long epoch_;
+    int active_;
+    bool stop_;
+};
+
+#endif // WORK_STEALING_H_